@@ -0,0 +1,65 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+
+void BenchmarkReport::print()
+{
+    if (json)
+    {
+        Array<var> objects;
+        for (auto& row : rows)
+        {
+            DynamicObject::Ptr obj = new DynamicObject();
+            for (int i = 0; i < row.size(); i++)
+                obj->setProperty(row.getName(i), row.getValueAt(i));
+            objects.add(var(obj.get()));
+        }
+        std::cout << JSON::toString(var(objects)) << std::endl;
+    }
+    else if (rows.size() > 0)
+    {
+        StringArray header;
+        for (int i = 0; i < rows.getReference(0).size(); i++)
+            header.add(rows.getReference(0).getName(i).toString());
+        std::cout << header.joinIntoString(",") << std::endl;
+
+        for (auto& row : rows)
+        {
+            StringArray fields;
+            for (int i = 0; i < row.size(); i++)
+                fields.add(row.getValueAt(i).toString());
+            std::cout << fields.joinIntoString(",") << std::endl;
+        }
+    }
+    rows.clear();
+}
+
+void BenchmarkReport::getStatistics(const Array<double>& samples, double& mean, double& stdDev)
+{
+    mean = stdDev = 0.0;
+    if (samples.size() == 0) return;
+
+    for (double s : samples) mean += s;
+    mean /= samples.size();
+
+    for (double s : samples) stdDev += (s - mean) * (s - mean);
+    stdDev = std::sqrt(stdDev / samples.size());
+}
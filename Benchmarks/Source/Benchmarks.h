@@ -0,0 +1,58 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// Collects benchmark results as rows of named values, and prints them as CSV or JSON,
+// so results can be compared across changes by scripts.
+class BenchmarkReport
+{
+public:
+    BenchmarkReport(bool asJson) : json(asJson) {}
+
+    void addRow(const NamedValueSet& row) { rows.add(row); }
+
+    // Print all rows to stdout, then clear them
+    void print();
+
+    // Mean and standard deviation of a set of measurements
+    static void getStatistics(const Array<double>& samples, double& mean, double& stdDev);
+
+private:
+    bool json;
+    Array<NamedValueSet> rows;
+};
+
+// Each benchmark adds its result rows to the given report
+void runStateRestoreBenchmark(BenchmarkReport& report);
+void runProcessorBenchmark(BenchmarkReport& report);
+void runOscillatorBenchmark(BenchmarkReport& report);
+void runOversamplingBenchmark(BenchmarkReport& report);
+void runMutedBenchmark(BenchmarkReport& report);
+void runPrecisionBenchmark(BenchmarkReport& report);
+void runVoiceScalingBenchmark(BenchmarkReport& report);
+void runParameterTextBenchmark(BenchmarkReport& report);
+void runScopeBenchmark(BenchmarkReport& report);
+void runPresetBankBenchmark(BenchmarkReport& report);
+
+// Not a benchmark: real-time safety audit of processBlock (see RealtimeSafetyAudit.h).
+// Returns the number of violations found, or -1 if this build does not support the audit.
+int runRealtimeAudit(BenchmarkReport& report);
@@ -0,0 +1,80 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+
+int main (int argc, char* argv[])
+{
+    // APVTS uses timers and async messages, so a MessageManager must exist
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    bool json = false;
+    StringArray benchmarks;
+    for (int i = 1; i < argc; i++)
+    {
+        String arg(argv[i]);
+        if (arg == "--json") json = true;
+        else if (arg == "--csv") json = false;
+        else benchmarks.add(arg);
+    }
+    if (benchmarks.isEmpty())
+    {
+        benchmarks.add("oscillator");
+        benchmarks.add("processor");
+        benchmarks.add("oversampling");
+        benchmarks.add("muted");
+        benchmarks.add("precision");
+        benchmarks.add("scope");
+        benchmarks.add("voices");
+        benchmarks.add("text");
+        benchmarks.add("presets");
+        benchmarks.add("restore");
+    }
+
+    BenchmarkReport report(json);
+    int exitCode = 0;
+    for (auto& name : benchmarks)
+    {
+        if (name == "audit")
+        {
+            // any violation (or an unsupported build) makes the run fail
+            if (runRealtimeAudit(report) != 0) exitCode = 1;
+        }
+        else if (name == "oscillator") runOscillatorBenchmark(report);
+        else if (name == "processor") runProcessorBenchmark(report);
+        else if (name == "oversampling") runOversamplingBenchmark(report);
+        else if (name == "muted") runMutedBenchmark(report);
+        else if (name == "precision") runPrecisionBenchmark(report);
+        else if (name == "scope") runScopeBenchmark(report);
+        else if (name == "voices") runVoiceScalingBenchmark(report);
+        else if (name == "text") runParameterTextBenchmark(report);
+        else if (name == "presets") runPresetBankBenchmark(report);
+        else if (name == "restore") runStateRestoreBenchmark(report);
+        else
+        {
+            std::cerr << "Unknown benchmark: " << name << std::endl
+                      << "Usage: Benchmarks [--csv|--json] [audit] [oscillator] [processor] [oversampling] [muted] [precision] [scope] [voices] [text] [presets] [restore]" << std::endl;
+            return 1;
+        }
+        report.print();
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    const int numRuns = 5;
+    const int callsPerRun = 200000;
+    const int numValues = 128;      // distinct values cycled through, for every parameter
+
+    // Time callsPerRun calls of fn(i % numValues); returns ns per call for each run
+    template <typename Function>
+    Array<double> timeCalls(Function fn)
+    {
+        Array<double> nsPerCall;
+        for (int run = 0; run < numRuns; run++)
+        {
+            int64 start = Time::getHighResolutionTicks();
+            for (int i = 0; i < callsPerRun; i++) fn(i % numValues);
+            double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+            nsPerCall.add(1.0e9 * seconds / callsPerRun);
+        }
+        return nsPerCall;
+    }
+
+    void addResultRow(BenchmarkReport& report, const char* parameterId, const char* method,
+                      const char* operation, const Array<double>& nsPerCall)
+    {
+        double mean, stdDev;
+        BenchmarkReport::getStatistics(nsPerCall, mean, stdDev);
+
+        NamedValueSet row;
+        row.set("benchmark", "text");
+        row.set("parameter", parameterId);
+        row.set("method", method);
+        row.set("operation", operation);
+        row.set("ns_per_call", mean);
+        row.set("stddev_ns", stdDev);
+        report.addRow(row);
+    }
+}
+
+// Time parameter text conversion as a host's generic editor does it, through
+// AudioProcessorParameter::getText() and getValueForText() (which use the shared text tables
+// for stepped parameters), against formatting and parsing with the parameter table's own
+// valueToText/textToValue functions, as before the tables existed
+void runParameterTextBenchmark(BenchmarkReport& report)
+{
+    PluginProcessor processor;
+
+    for (int p = 0; p < kNumParameters; p++)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[p];
+        AudioProcessorParameterWithID* param = processor.valueTreeState.getParameter(spec.id);
+
+        float normalised[numValues];
+        float values[numValues];
+        StringArray texts;
+        for (int i = 0; i < numValues; i++)
+        {
+            normalised[i] = i / (numValues - 1.0f);
+            values[i] = spec.minValue + normalised[i] * (spec.maxValue - spec.minValue);
+            texts.add(spec.valueToText(values[i]));
+        }
+
+        // accumulate results, so the calls cannot be optimised away
+        int totalLength = 0;
+        float totalValue = 0.0f;
+
+        addResultRow(report, spec.id, "host", "get_text",
+                     timeCalls([&](int i) { totalLength += param->getText(normalised[i], 1024).length(); }));
+        addResultRow(report, spec.id, "formatted", "get_text",
+                     timeCalls([&](int i) { totalLength += spec.valueToText(values[i]).length(); }));
+        addResultRow(report, spec.id, "host", "get_value_for_text",
+                     timeCalls([&](int i) { totalValue += param->getValueForText(texts[i]); }));
+        addResultRow(report, spec.id, "parsed", "get_value_for_text",
+                     timeCalls([&](int i) { totalValue += spec.textToValue(texts[i]); }));
+
+        if (totalLength < 0 || totalValue < 0.0f) std::cerr << "unexpected result" << std::endl;
+    }
+}
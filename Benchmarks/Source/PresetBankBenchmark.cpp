@@ -0,0 +1,118 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int numBlocks = 2000;
+
+    double elapsedMicroseconds(int64 startTicks)
+    {
+        return 1.0e6 * Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    }
+
+    void addResultRow(BenchmarkReport& report, int numPresets, const char* operation, double meanUs, double stdDevUs)
+    {
+        NamedValueSet row;
+        row.set("benchmark", "presets");
+        row.set("presets", numPresets);
+        row.set("operation", operation);
+        row.set("mean_us", meanUs);
+        row.set("stddev_us", stdDevUs);
+        report.addRow(row);
+    }
+
+    // Write a bank of numPresets presets with random values
+    bool writeBank(const File& bankFile, int numPresets)
+    {
+        Random random(numPresets);
+        StringArray names;
+        HeapBlock<float> values((size_t)numPresets * kNumParameters);
+        for (int p = 0; p < numPresets; p++)
+        {
+            names.add("Preset " + String(p + 1));
+            for (int i = 0; i < kNumParameters; i++)
+                values[p * kNumParameters + i] = random.nextFloat();
+        }
+        return PresetBank::write(bankFile, names, values);
+    }
+}
+
+// For banks of increasing size: time opening the bank, reading every preset name (as a
+// preset browser or the host's program list does), and processing blocks which switch
+// program at their start, against blocks which do not
+void runPresetBankBenchmark(BenchmarkReport& report)
+{
+    const int bankSizes[] = { 128, 1024, 16384, 131072 };
+    const File bankFile = File::getSpecialLocation(File::tempDirectory).getChildFile("PresetBankBenchmark.bank");
+
+    for (int numPresets : bankSizes)
+    {
+        if (!writeBank(bankFile, numPresets))
+        {
+            std::cerr << "could not write " << bankFile.getFullPathName() << std::endl;
+            return;
+        }
+
+        PluginProcessor processor;
+        int64 start = Time::getHighResolutionTicks();
+        const bool opened = processor.loadPresetBank(bankFile);
+        addResultRow(report, numPresets, "open", elapsedMicroseconds(start), 0.0);
+        if (!opened) continue;
+
+        start = Time::getHighResolutionTicks();
+        int totalLength = 0;
+        for (int p = 0; p < processor.getNumPrograms(); p++)
+            totalLength += processor.getProgramName(p).length();
+        addResultRow(report, numPresets, "all_names", elapsedMicroseconds(start), 0.0);
+        if (totalLength <= 0) std::cerr << "unexpected result" << std::endl;
+
+        processor.setPlayConfigDetails(0, 2, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        AudioBuffer<float> buffer(2, blockSize);
+        MidiBuffer midi;
+
+        Array<double> switchTimes, steadyTimes;
+        Random random(1);
+        for (int b = 0; b < numBlocks; b++)
+        {
+            // alternate switching and steady blocks, so both see the same cache conditions
+            const bool switching = (b & 1) == 0;
+            if (switching) processor.setCurrentProgram(random.nextInt(numPresets));
+
+            start = Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            (switching ? switchTimes : steadyTimes).add(elapsedMicroseconds(start));
+        }
+        processor.releaseResources();
+
+        double mean, stdDev;
+        BenchmarkReport::getStatistics(switchTimes, mean, stdDev);
+        addResultRow(report, numPresets, "switch_block", mean, stdDev);
+        BenchmarkReport::getStatistics(steadyTimes, mean, stdDev);
+        addResultRow(report, numPresets, "steady_block", mean, stdDev);
+    }
+
+    bankFile.deleteFile();
+}
@@ -0,0 +1,342 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    const int blockSizes[] = { 32, 64, 128, 256, 512, 1024, 2048 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const int numRuns = 5;
+    const double secondsPerRun = 2.0;
+
+    void setChoice(PluginProcessor& processor, ParameterIndex index, int choice)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[index];
+        AudioProcessorParameterWithID* param = processor.valueTreeState.getParameter(spec.id);
+        param->setValueNotifyingHost((choice - spec.minValue) / (spec.maxValue - spec.minValue));
+    }
+
+    // Render a few seconds of audio several times; returns ns per sample for each run
+    template <typename SampleType>
+    Array<double> timeProcessBlock(PluginProcessor& processor, AudioBuffer<SampleType>& buffer, double sampleRate)
+    {
+        MidiBuffer midi;
+        const int blockSize = buffer.getNumSamples();
+        const int blocksPerRun = jmax(1, (int)(secondsPerRun * sampleRate / blockSize));
+
+        // warm up caches and let parameter smoothing settle
+        for (int i = 0; i < 16; i++) processor.processBlock(buffer, midi);
+
+        Array<double> nsPerSample;
+        for (int run = 0; run < numRuns; run++)
+        {
+            int64 start = Time::getHighResolutionTicks();
+            for (int i = 0; i < blocksPerRun; i++)
+                processor.processBlock(buffer, midi);
+            double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+            nsPerSample.add(1.0e9 * seconds / ((double)blocksPerRun * blockSize));
+        }
+        return nsPerSample;
+    }
+
+    void addResultRow(BenchmarkReport& report, const char* benchmark, int blockSize, double sampleRate,
+                      int numChannels, int waveformIndex, const Array<double>& nsPerSample)
+    {
+        double mean, stdDev;
+        BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+        NamedValueSet row;
+        row.set("benchmark", benchmark);
+        row.set("block_size", blockSize);
+        row.set("sample_rate", sampleRate);
+        row.set("channels", numChannels);
+        row.set("waveform", SynthWaveform::names[waveformIndex]);
+        row.set("ns_per_sample", mean);
+        row.set("stddev_ns", stdDev);
+        row.set("realtime_factor", mean > 0.0 ? 1.0e9 / (mean * sampleRate) : 0.0);
+        report.addRow(row);
+    }
+}
+
+// Time PluginProcessor::processBlock, created directly with no host or editor, across block
+// sizes, sample rates, output layouts (mono to 7.1) and waveforms. Each configuration is rendered for
+// several runs of a few seconds of audio; the spread between runs is reported as stddev.
+void runProcessorBenchmark(BenchmarkReport& report)
+{
+    const AudioChannelSet layouts[] = { AudioChannelSet::mono(), AudioChannelSet::stereo(),
+                                        AudioChannelSet::create5point1(), AudioChannelSet::create7point1() };
+
+    for (auto& layout : layouts)
+    {
+        for (double sampleRate : sampleRates)
+        {
+            for (int blockSize : blockSizes)
+            {
+                for (int wf = 0; wf < SynthWaveform::kChoices; wf++)
+                {
+                    PluginProcessor processor;
+                    AudioProcessor::BusesLayout busesLayout;
+                    busesLayout.inputBuses.add(layout);
+                    busesLayout.outputBuses.add(layout);
+                    processor.setBusesLayout(busesLayout);
+                    setChoice(processor, kWaveform, wf);
+
+                    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    AudioSampleBuffer buffer(layout.size(), blockSize);
+                    Array<double> nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+                    processor.releaseResources();
+                    addResultRow(report, "processor", blockSize, sampleRate, layout.size(), wf, nsPerSample);
+                }
+            }
+        }
+    }
+}
+
+// Time PluginProcessor::processBlock at each oversampling factor (stereo, 48 kHz, sawtooth,
+// which has the most high harmonics), to show the cost of each quality setting
+void runOversamplingBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+    const int sawtooth = SynthWaveform::kChoices - 1;
+
+    for (int factorLog2 = 0; factorLog2 <= SynthOversampler<float>::kMaxFactorLog2; factorLog2++)
+    {
+        for (int blockSize : blockSizes)
+        {
+            PluginProcessor processor;
+            setChoice(processor, kWaveform, sawtooth);
+            setChoice(processor, kOversampling, factorLog2);
+
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            AudioSampleBuffer buffer(2, blockSize);
+            Array<double> nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            processor.releaseResources();
+
+            double mean, stdDev;
+            BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+            NamedValueSet row;
+            row.set("benchmark", "oversampling");
+            row.set("oversampling", 1 << factorLog2);
+            row.set("block_size", blockSize);
+            row.set("latency_samples", processor.getLatencySamples());
+            row.set("ns_per_sample", mean);
+            row.set("stddev_ns", stdDev);
+            row.set("realtime_factor", mean > 0.0 ? 1.0e9 / (mean * sampleRate) : 0.0);
+            report.addRow(row);
+        }
+    }
+}
+
+// Time PluginProcessor::processBlock with the level at zero vs. playing, to show the cost of
+// a muted instance (stereo, 48 kHz)
+void runMutedBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+    const ParameterSpec& levelSpec = PluginParameters::specs[kLevel];
+
+    for (int muted = 0; muted < 2; muted++)
+    {
+        for (int blockSize : blockSizes)
+        {
+            PluginProcessor processor;
+            AudioProcessorParameterWithID* level = processor.valueTreeState.getParameter(levelSpec.id);
+            level->setValueNotifyingHost(muted ? 0.0f : 0.5f);
+
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            AudioSampleBuffer buffer(2, blockSize);
+            Array<double> nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            processor.releaseResources();
+
+            double mean, stdDev;
+            BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+            NamedValueSet row;
+            row.set("benchmark", "muted");
+            row.set("muted", muted != 0);
+            row.set("block_size", blockSize);
+            row.set("ns_per_sample", mean);
+            row.set("stddev_ns", stdDev);
+            report.addRow(row);
+        }
+    }
+}
+
+// Time PluginProcessor::processBlock with oscilloscope capture off (no editor) and on, to
+// show what the scope costs the audio thread (stereo, 48 kHz)
+void runScopeBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+
+    for (int capture = 0; capture < 2; capture++)
+    {
+        for (int blockSize : blockSizes)
+        {
+            PluginProcessor processor;
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            // nothing drains the FIFO here, so once it is full peaks are computed but dropped
+            processor.scopeBuffer.setEnabled(capture != 0);
+
+            AudioSampleBuffer buffer(2, blockSize);
+            Array<double> nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            processor.releaseResources();
+
+            double mean, stdDev;
+            BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+            NamedValueSet row;
+            row.set("benchmark", "scope");
+            row.set("capture", capture != 0);
+            row.set("block_size", blockSize);
+            row.set("ns_per_sample", mean);
+            row.set("stddev_ns", stdDev);
+            report.addRow(row);
+        }
+    }
+}
+
+// Time PluginProcessor::processBlock in single and double precision (stereo, 48 kHz)
+void runPrecisionBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+
+    for (int useDouble = 0; useDouble < 2; useDouble++)
+    {
+        for (int blockSize : blockSizes)
+        {
+            PluginProcessor processor;
+            processor.setProcessingPrecision(useDouble ? AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            Array<double> nsPerSample;
+            if (useDouble)
+            {
+                AudioBuffer<double> buffer(2, blockSize);
+                nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            }
+            else
+            {
+                AudioBuffer<float> buffer(2, blockSize);
+                nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            }
+            processor.releaseResources();
+
+            double mean, stdDev;
+            BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+            NamedValueSet row;
+            row.set("benchmark", "precision");
+            row.set("precision", useDouble ? "double" : "float");
+            row.set("block_size", blockSize);
+            row.set("ns_per_sample", mean);
+            row.set("stddev_ns", stdDev);
+            report.addRow(row);
+        }
+    }
+}
+
+// Time PluginProcessor::processBlock with many held voices, rendered on 0 to (CPUs - 1) worker
+// threads, to show how voice rendering scales with cores (stereo, 48 kHz, 512-sample blocks)
+void runVoiceScalingBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int voiceCounts[] = { 64, 256, 1024 };
+
+    for (int numVoices : voiceCounts)
+    {
+        for (int numWorkers = 0; numWorkers < SystemStats::getNumCpus(); numWorkers++)
+        {
+            PluginProcessor processor;
+            processor.voices.setMaxVoices(numVoices);
+            processor.setVoiceThreading(numWorkers, 1);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            // start all the voices, spread over the keyboard
+            AudioSampleBuffer buffer(2, blockSize);
+            MidiBuffer notes;
+            for (int i = 0; i < numVoices; i++)
+                notes.addEvent(MidiMessage::noteOn(1, 24 + i % 72, 0.1f), 0);
+            processor.processBlock(buffer, notes);
+
+            Array<double> nsPerSample = timeProcessBlock(processor, buffer, sampleRate);
+            processor.releaseResources();
+
+            double mean, stdDev;
+            BenchmarkReport::getStatistics(nsPerSample, mean, stdDev);
+
+            NamedValueSet row;
+            row.set("benchmark", "voice_scaling");
+            row.set("voices", numVoices);
+            row.set("threads", numWorkers + 1);
+            row.set("ns_per_sample", mean);
+            row.set("stddev_ns", stdDev);
+            row.set("realtime_factor", mean > 0.0 ? 1.0e9 / (mean * sampleRate) : 0.0);
+            report.addRow(row);
+        }
+    }
+}
+
+// Time SynthOscillator::renderBlock alone, per waveform and block size, at middle C
+void runOscillatorBenchmark(BenchmarkReport& report)
+{
+    const double sampleRate = 48000.0;
+
+    for (int blockSize : blockSizes)
+    {
+        for (int wf = 0; wf < SynthWaveform::kChoices; wf++)
+        {
+            SynthWaveform waveform;
+            waveform.setIndex(wf);
+
+            SynthOscillator oscillator;
+            oscillator.setWaveform(waveform);
+            oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(60) / sampleRate);
+            oscillator.resetSmoothing(0.5f);
+
+            HeapBlock<float> buffer(blockSize);
+            const int blocksPerRun = jmax(1, (int)(secondsPerRun * sampleRate / blockSize));
+
+            Array<double> nsPerSample;
+            for (int run = 0; run < numRuns; run++)
+            {
+                int64 start = Time::getHighResolutionTicks();
+                for (int i = 0; i < blocksPerRun; i++)
+                    oscillator.renderBlock(buffer.get(), blockSize, 0.5f);
+                double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+                nsPerSample.add(1.0e9 * seconds / ((double)blocksPerRun * blockSize));
+            }
+
+            addResultRow(report, "oscillator", blockSize, sampleRate, 1, wf, nsPerSample);
+        }
+    }
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/RealtimeSafetyAudit.h"
+
+namespace
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 256;
+    const int numChordNotes = 8;
+    const int numAuditPresets = 200;
+
+    // Plays the role of the host's audio thread: delivers parameter automation, then calls
+    // processBlock, with both inside real-time audit sections. Besides notes, the blocks
+    // exercise the audio-thread paths with most to go wrong: oversampling changes, MIDI program
+    // changes (with crossfades), and chords large enough to render on the voice worker pool.
+    class AuditAudioThread : public Thread
+    {
+    public:
+        AuditAudioThread(PluginProcessor& p)
+            : Thread("Audit audio thread")
+            , processor(p)
+            , buffer(2, blockSize)
+            , numBlocks(0)
+        {
+            // resolve parameters and build MIDI buffers here, so the audio thread does no lookups
+            // or allocation of its own
+            levelParam = processor.valueTreeState.getParameter(PluginParameters::specs[kLevel].id);
+            noteParam = processor.valueTreeState.getParameter(PluginParameters::specs[kMidiNoteNumber].id);
+            oversamplingParam = processor.valueTreeState.getParameter(PluginParameters::specs[kOversampling].id);
+            for (int i = 0; i < numChordNotes; i++)
+            {
+                notesOn.addEvent(MidiMessage::noteOn(1, 48 + 3 * i, 0.8f), 17 + 10 * i);
+                notesOff.addEvent(MidiMessage::noteOff(1, 48 + 3 * i), 5 + 20 * i);
+            }
+            for (int i = 0; i < numProgramBuffers; i++)
+                programChanges[i].addEvent(MidiMessage::programChange(1, (7 * i) % 128), 0);
+        }
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                {
+                    // host automation, delivered on the audio thread as JUCE's plugin wrappers
+                    // deliver it: straight to the parameter with setValue(), which does not
+                    // notify the host back
+                    RealtimeSafetyAudit::ScopedSection section;
+                    levelParam->setValue((numBlocks % 100) / 100.0f);
+                    if (numBlocks % 50 == 0)
+                        noteParam->setValue((numBlocks % 400) / 400.0f);
+                    if (numBlocks % 150 == 75)
+                        oversamplingParam->setValue(((numBlocks / 150) % 4) / 3.0f);
+                }
+
+                MidiBuffer* midi = &empty;
+                if (numBlocks % 20 == 0) midi = &notesOn;
+                else if (numBlocks % 20 == 10) midi = &notesOff;
+                else if (numBlocks % 20 == 5) midi = &programChanges[(numBlocks / 20) % numProgramBuffers];
+                processor.processBlock(buffer, *midi);
+                numBlocks++;
+
+                // roughly real-time pacing, outside the audited section
+                Thread::sleep(1);
+            }
+        }
+
+        PluginProcessor& processor;
+        AudioSampleBuffer buffer;
+        MidiBuffer notesOn, notesOff, empty;
+        static const int numProgramBuffers = 16;
+        MidiBuffer programChanges[numProgramBuffers];
+        AudioProcessorParameterWithID* levelParam;
+        AudioProcessorParameterWithID* noteParam;
+        AudioProcessorParameterWithID* oversamplingParam;
+        int numBlocks;
+    };
+}
+
+// Run the processor on an audio thread for a few seconds, with the real-time safety audit
+// active, while the main (message) thread restores state, makes GUI-style parameter edits,
+// performs undo/redo and changes program as a host does. Voices render on the worker pool
+// whenever a chord is held. Returns the number of violations found on the audio thread.
+int runRealtimeAudit(BenchmarkReport& report)
+{
+    if (!RealtimeSafetyAudit::isAvailable())
+    {
+        std::cerr << "The audit requires a build with RT_SAFETY_AUDIT=1 (the Audit configuration)" << std::endl;
+        return -1;
+    }
+
+    const double seconds = 5.0;
+
+    PluginProcessor processor;
+
+    // a bank to change programs in, with random values for every parameter
+    const File bankFile = File::getSpecialLocation(File::tempDirectory).getChildFile("RealtimeAudit.bank");
+    {
+        Random random(1);
+        StringArray names;
+        HeapBlock<float> values((size_t)numAuditPresets * kNumParameters);
+        for (int p = 0; p < numAuditPresets; p++)
+        {
+            names.add("Audit " + String(p + 1));
+            for (int i = 0; i < kNumParameters; i++)
+                values[p * kNumParameters + i] = random.nextFloat();
+        }
+        if (!PresetBank::write(bankFile, names, values) || !processor.loadPresetBank(bankFile))
+            std::cerr << "could not write a preset bank; program changes are not audited" << std::endl;
+    }
+
+    // chords are rendered on worker threads
+    processor.setVoiceThreading(2, numChordNotes / 2);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    MemoryBlock savedState;
+    processor.getStateInformation(savedState);
+    AudioProcessorParameterWithID* waveform = processor.valueTreeState.getParameter(PluginParameters::specs[kWaveform].id);
+    const float waveformStep = 1.0f / (SynthWaveform::kChoices - 1);
+
+    RealtimeSafetyAudit::reset();
+    AuditAudioThread audioThread(processor);
+    audioThread.startThread(9);
+
+    const double endTime = Time::getMillisecondCounterHiRes() + 1000.0 * seconds;
+    for (int i = 0; Time::getMillisecondCounterHiRes() < endTime; i++)
+    {
+        switch (i % 5)
+        {
+        case 0:
+            processor.setStateInformation(savedState.getData(), (int)savedState.getSize());
+            break;
+        case 1:
+            // a user edit, as the editor makes it
+            waveform->beginChangeGesture();
+            waveform->setValueNotifyingHost(((i / 4) % SynthWaveform::kChoices) * waveformStep);
+            waveform->endChangeGesture();
+            break;
+        case 2:
+            processor.undoManager.undo();
+            break;
+        case 3:
+            processor.undoManager.redo();
+            break;
+        case 4:
+            // a host program change (queued for the audio thread)
+            processor.setCurrentProgram((i / 5) % numAuditPresets);
+            break;
+        }
+
+        // let timers and async updates (e.g. ValueTree synchronization) run
+        MessageManager::getInstance()->runDispatchLoopUntil(10);
+    }
+
+    audioThread.stopThread(1000);
+    processor.releaseResources();
+    bankFile.deleteFile();
+
+    const int numViolations = RealtimeSafetyAudit::getNumViolations();
+
+    NamedValueSet row;
+    row.set("benchmark", "audit");
+    row.set("seconds", seconds);
+    row.set("blocks", audioThread.numBlocks);
+    row.set("violations", numViolations);
+    report.addRow(row);
+
+    return numViolations;
+}
@@ -0,0 +1,128 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "Benchmarks.h"
+#include "../../Source/ParameterBulkLoader.h"
+
+namespace
+{
+    // Minimal processor with an arbitrary number of float parameters in an
+    // AudioProcessorValueTreeState, set up the same way as PluginProcessor's (with no UndoManager)
+    class SyntheticProcessor : public AudioProcessor
+    {
+    public:
+        SyntheticProcessor(int numParameters)
+            : valueTreeState(*this, nullptr)
+        {
+            for (int i = 0; i < numParameters; i++)
+            {
+                ids.add("p" + String(i));
+                valueTreeState.createAndAddParameter(ids[i], ids[i], String(),
+                    NormalisableRange<float>(0.0f, 1.0f), 0.0f, nullptr, nullptr);
+            }
+            valueTreeState.state = ValueTree(Identifier("Synthetic"));
+        }
+
+        void prepareToPlay(double, int) override {}
+        void releaseResources() override {}
+        void processBlock(AudioSampleBuffer&, MidiBuffer&) override {}
+        AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+        const String getName() const override { return "Synthetic"; }
+        bool acceptsMidi() const override { return false; }
+        bool producesMidi() const override { return false; }
+        double getTailLengthSeconds() const override { return 0.0; }
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram(int) override {}
+        const String getProgramName(int) override { return {}; }
+        void changeProgramName(int, const String&) override {}
+        void getStateInformation(MemoryBlock&) override {}
+        void setStateInformation(const void*, int) override {}
+
+        AudioProcessorValueTreeState valueTreeState;
+        StringArray ids;
+    };
+
+    double elapsedMicroseconds(int64 startTicks)
+    {
+        return 1.0e6 * Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    }
+
+    void addResultRow(BenchmarkReport& report, int numParameters, const char* method, const Array<double>& times)
+    {
+        double mean, stdDev;
+        BenchmarkReport::getStatistics(times, mean, stdDev);
+
+        NamedValueSet row;
+        row.set("benchmark", "restore");
+        row.set("parameters", numParameters);
+        row.set("method", method);
+        row.set("mean_us", mean);
+        row.set("stddev_us", stdDev);
+        row.set("us_per_parameter", mean / numParameters);
+        report.addRow(row);
+    }
+}
+
+// Time restoring every parameter of a processor, one at a time through getParameterAsValue()
+// (the old PluginParameters::getFromXml approach) versus in one batch via ParameterBulkLoader,
+// for increasing parameter counts. The bulk path leaves the ValueTree to be brought up to date
+// by the AudioProcessorValueTreeState's timer, so both timings include copyState(), which
+// flushes the parameter values to the ValueTree, to measure the same finished state.
+void runStateRestoreBenchmark(BenchmarkReport& report)
+{
+    const int parameterCounts[] = { 4, 16, 64, 256, 1024, 4096 };
+    const int numRepetitions = 20;
+
+    for (int numParameters : parameterCounts)
+    {
+        SyntheticProcessor processor(numParameters);
+        ParameterBulkLoader loader(processor.valueTreeState, processor.ids);
+        Array<double> perParameterTimes, bulkTimes;
+
+        for (int rep = 0; rep < numRepetitions; rep++)
+        {
+            // alternate values, so every restore actually changes every parameter
+            const float value = (rep & 1) ? 0.25f : 0.75f;
+            int64 start = Time::getHighResolutionTicks();
+            for (auto& id : processor.ids)
+                processor.valueTreeState.getParameterAsValue(id).setValue(value);
+            processor.valueTreeState.copyState();
+            perParameterTimes.add(elapsedMicroseconds(start));
+        }
+
+        for (int rep = 0; rep < numRepetitions; rep++)
+        {
+            const float value = (rep & 1) ? 0.25f : 0.75f;
+            NamedValueSet values;
+            for (auto& id : processor.ids)
+                values.set(id, value);
+
+            int64 start = Time::getHighResolutionTicks();
+            loader.applyValues(values);
+            processor.valueTreeState.copyState();
+            bulkTimes.add(elapsedMicroseconds(start));
+        }
+
+        addResultRow(report, numParameters, "per-parameter", perParameterTimes);
+        addResultRow(report, numParameters, "bulk", bulkTimes);
+    }
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "RenderScript.h"
+#include "SegmentRenderJob.h"
+
+namespace
+{
+    const double kMinSegmentSeconds = 5.0;      // shorter segments spend too long on setup and pre-roll
+    const int64 kMaxSegmentValues = 1 << 24;    // samples x channels held by one segment (64 MB)
+
+    // Everything needed to render one script: its events, and the writer its segments stream to
+    struct RenderTask
+    {
+        RenderScript script;
+        Array<AutomationEvent> events;
+        int64 totalSamples = 0;
+        ScopedPointer<AudioFormatWriter> writer;
+        bool failed = false;
+    };
+
+    // One segment of one task; segments are rendered in any order but written in order
+    struct Segment
+    {
+        RenderTask* task;
+        int64 startSample, endSample;
+    };
+
+    bool openWavFile(RenderTask& task, double sampleRate)
+    {
+        task.script.outputFile.deleteFile();
+        ScopedPointer<FileOutputStream> stream(task.script.outputFile.createOutputStream());
+        if (stream == nullptr) return false;
+
+        WavAudioFormat wav;
+        task.writer = wav.createWriterFor(stream, sampleRate, (unsigned int)task.script.numChannels,
+                                          task.script.bitsPerSample, {}, 0);
+        if (task.writer == nullptr) return false;
+        stream.release();   // now owned by the writer
+        return true;
+    }
+
+    int usage()
+    {
+        std::cerr << "Usage: OfflineRender [--threads N] [--block-size N] [--sample-rate R] script..." << std::endl;
+        return 1;
+    }
+}
+
+// Render each script to a WAV file. All scripts' segments go into one thread pool, so separate
+// scripts and separate parts of one long script render in parallel.
+int main (int argc, char* argv[])
+{
+    // APVTS uses timers and async messages, so a MessageManager must exist
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    int numThreads = SystemStats::getNumCpus();
+    int blockSize = 8192;
+    double sampleRate = 48000.0;
+    StringArray scriptPaths;
+    for (int i = 1; i < argc; i++)
+    {
+        String arg(argv[i]);
+        if (arg.startsWith("--") && i + 1 >= argc) return usage();
+        if (arg == "--threads") numThreads = String(argv[++i]).getIntValue();
+        else if (arg == "--block-size") blockSize = String(argv[++i]).getIntValue();
+        else if (arg == "--sample-rate") sampleRate = String(argv[++i]).getDoubleValue();
+        else if (arg.startsWith("--")) return usage();
+        else scriptPaths.add(arg);
+    }
+    if (scriptPaths.isEmpty() || numThreads < 1 || blockSize < 1 || sampleRate <= 0.0) return usage();
+
+    const File cwd = File::getCurrentWorkingDirectory();
+    OwnedArray<RenderTask> tasks;
+    for (auto& path : scriptPaths)
+    {
+        RenderTask* task = tasks.add(new RenderTask());
+        String error = task->script.load(cwd.getChildFile(path));
+        if (error.isNotEmpty())
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    const int64 startTicks = Time::getHighResolutionTicks();
+    Array<Segment> segments;
+    for (auto* task : tasks)
+    {
+        task->totalSamples = (int64)std::llround(task->script.lengthSeconds * sampleRate);
+        task->events = task->script.getEvents(sampleRate);
+
+        // split among the threads, but keep each segment's buffer bounded however many channels
+        const int64 segmentSamples = jmax((int64)std::llround(kMinSegmentSeconds * sampleRate),
+                                          jmin((task->totalSamples + numThreads - 1) / numThreads,
+                                               kMaxSegmentValues / task->script.numChannels));
+        for (int64 start = 0; start < task->totalSamples; start += segmentSamples)
+            segments.add({ task, start, jmin(task->totalSamples, start + segmentSamples) });
+    }
+
+    // Segments are queued a few at a time, and each is written to its file and freed as soon as it
+    // and all segments before it are done, so memory stays bounded however long the output is.
+    const int maxSegmentsInFlight = 2 * numThreads;
+    ThreadPool pool(numThreads);
+    OwnedArray<SegmentRenderJob> jobs;  // segments [written, written + jobs.size()), in order
+    int exitCode = 0;
+    double audioSeconds = 0.0;
+    for (int written = 0; written < segments.size(); written++)
+    {
+        for (int queued = written + jobs.size(); queued < segments.size() && jobs.size() < maxSegmentsInFlight; queued++)
+        {
+            const Segment& segment = segments.getReference(queued);
+            auto* job = new SegmentRenderJob(segment.task->events, segment.task->script.numChannels,
+                                             segment.startSample, segment.endSample, sampleRate, blockSize);
+            jobs.add(job);
+            pool.addJob(job, false);
+        }
+
+        const Segment& segment = segments.getReference(written);
+        RenderTask& task = *segment.task;
+        pool.waitForJobToFinish(jobs[0], -1);
+
+        if (segment.startSample == 0 && !openWavFile(task, sampleRate))
+            task.failed = true;
+        if (!task.failed)
+        {
+            const AudioBuffer<float>& output = jobs[0]->getOutput();
+            task.failed = !task.writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+        }
+        jobs.remove(0);
+
+        if (segment.endSample == task.totalSamples)
+        {
+            task.writer = nullptr;  // flushes and closes the file
+            const File& file = task.script.outputFile;
+            if (!task.failed)
+            {
+                std::cout << "Wrote " << file.getFullPathName() << std::endl;
+                audioSeconds += task.script.lengthSeconds;
+            }
+            else
+            {
+                std::cerr << "Could not write " << file.getFullPathName() << std::endl;
+                exitCode = 1;
+            }
+        }
+    }
+
+    const double wallSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    std::cout << "Rendered " << audioSeconds << " s of audio in " << wallSeconds << " s ("
+              << (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0) << "x realtime, "
+              << numThreads << " threads)" << std::endl;
+
+    return exitCode;
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "RenderScript.h"
+#include "../../Source/PluginParameters.h"
+#include "../../Source/ParameterTextTable.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    // Parse text which must be a whole decimal number, e.g. "-1.5" or "2e3" but not "2x" or ""
+    bool parseNumber(const String& text, double& number)
+    {
+        const char* begin = text.toRawUTF8();
+        char* end = nullptr;
+        number = std::strtod(begin, &end);
+        return end != begin && *end == 0 && std::isfinite(number);
+    }
+
+    bool parseInt(const String& text, int& number)
+    {
+        double d;
+        if (!parseNumber(text, d) || d != std::floor(d) || std::abs(d) > std::numeric_limits<int>::max()) return false;
+        number = (int)d;
+        return true;
+    }
+
+    // A stepped parameter's value must be one of the texts the GUI shows (an integer parameter
+    // may also be given as a number); any other parameter's value must be a number. Either must
+    // be in range: nothing is clamped, so a typo cannot silently render something else.
+    String parseParameterValue(int parameterIndex, const String& text, float& value)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[parameterIndex];
+        const ParameterTextTable* table = ParameterTextTable::get(parameterIndex);
+        if (table != nullptr && table->parse(text, value)) return {};
+
+        double number;
+        if (spec.type == kChoiceParameter || spec.type == kBoolParameter || !parseNumber(text, number))
+            return "invalid " + String(spec.id) + " value \"" + text + "\"";
+
+        value = spec.textToValue(text);
+        if (spec.type == kIntegerParameter && value != std::floor(value))
+            return String(spec.id) + " must be a whole number";
+        if (value < spec.minValue || value > spec.maxValue)
+            return String(spec.id) + " must be " + PluginParameters::getText(parameterIndex, spec.minValue)
+                 + " to " + PluginParameters::getText(parameterIndex, spec.maxValue);
+        return {};
+    }
+}
+
+String RenderScript::load(const File& scriptFile)
+{
+    if (!scriptFile.existsAsFile())
+        return "cannot read " + scriptFile.getFullPathName();
+
+    scriptFolder = scriptFile.getParentDirectory();
+    StringArray lines;
+    scriptFile.readLines(lines);
+
+    for (int i = 0; i < lines.size(); i++)
+    {
+        String error = parseLine(lines[i].upToFirstOccurrenceOf("#", false, false).trim());
+        if (error.isNotEmpty())
+            return scriptFile.getFileName() + " line " + String(i + 1) + ": " + error;
+    }
+
+    if (outputFile == File()) return scriptFile.getFileName() + ": no output file given";
+    if (lengthSeconds <= 0.0) return scriptFile.getFileName() + ": no length given";
+    return {};
+}
+
+String RenderScript::parseLine(const String& line)
+{
+    if (line.isEmpty()) return {};
+
+    StringArray tokens;
+    tokens.addTokens(line, " \t", "\"");
+    tokens.removeEmptyStrings();
+    const String keyword = tokens[0];
+    const String argument = tokens.size() > 1 ? tokens[1].unquoted() : String();
+
+    if (keyword == "output")
+    {
+        if (argument.isEmpty()) return "missing file name";
+        outputFile = scriptFolder.getChildFile(argument);
+        return {};
+    }
+    if (keyword == "length")
+    {
+        return (parseNumber(argument, lengthSeconds) && lengthSeconds > 0.0) ? String() : "length must be a positive number of seconds";
+    }
+    if (keyword == "channels")
+    {
+        return (parseInt(argument, numChannels) && numChannels >= 1 && numChannels <= PluginProcessor::kMaxOutputChannels)
+            ? String() : "channels must be 1 to " + String(PluginProcessor::kMaxOutputChannels);
+    }
+    if (keyword == "bits")
+    {
+        return (parseInt(argument, bitsPerSample) && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)) ? String() : "bits must be 16, 24 or 32";
+    }
+
+    // anything else is an automation event: <time> <parameter id> <value text>
+    double seconds;
+    if (!parseNumber(keyword, seconds)) return "unknown statement \"" + keyword + "\"";
+    if (seconds < 0.0) return "time must not be negative";
+    if (tokens.size() < 3) return "expected <time> <parameter id> <value>";
+
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[i];
+        if (argument == spec.id)
+        {
+            float value;
+            const String error = parseParameterValue(i, tokens.joinIntoString(" ", 2).unquoted(), value);
+            if (error.isEmpty()) automation.add({ seconds, i, value });
+            return error;
+        }
+    }
+    return "unknown parameter \"" + argument + "\"";
+}
+
+Array<AutomationEvent> RenderScript::getEvents(double sampleRate) const
+{
+    Array<AutomationEvent> events;
+    for (auto& tv : automation)
+        events.add({ (int64)std::llround(tv.seconds * sampleRate), tv.parameterIndex, tv.value });
+
+    // stable, so events at the same time are applied in script order
+    std::stable_sort(events.begin(), events.end(), [](const AutomationEvent& a, const AutomationEvent& b)
+                     { return a.samplePosition < b.samplePosition; });
+    return events;
+}
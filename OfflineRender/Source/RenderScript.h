@@ -0,0 +1,71 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// One parameter change in a render script, in samples from the start of the render
+struct AutomationEvent
+{
+    int64 samplePosition;
+    int parameterIndex;     // ParameterIndex of the parameter to change
+    float value;            // plain (not normalised) parameter value
+};
+
+// A render script describes one output file: its format and length, and a list of timed
+// parameter changes. Scripts are plain text, one statement per line; '#' starts a comment.
+//
+//     output   render.wav      # output file, relative to the script's folder
+//     length   30              # seconds
+//     channels 2               # optional: 1 to PluginProcessor::kMaxOutputChannels, default 2
+//     bits     24              # optional: 16, 24 or 32 (float), default 24
+//     0    waveform Sine       # <time in seconds> <parameter id> <value, as the GUI shows it>
+//     10.5 midiNoteNumber 72
+//
+// A value that does not parse, or is out of range, is an error rather than being clamped.
+// The sample rate is not part of the script, so the same script can be rendered at any rate.
+class RenderScript
+{
+public:
+    RenderScript() : lengthSeconds(0.0), numChannels(2), bitsPerSample(24) {}
+
+    // Parse a script file; returns an error message, or an empty string on success
+    String load(const File& scriptFile);
+
+    // Event times converted to samples at the given rate, sorted by position
+    Array<AutomationEvent> getEvents(double sampleRate) const;
+
+    File outputFile;
+    double lengthSeconds;
+    int numChannels;
+    int bitsPerSample;
+
+private:
+    struct TimedValue
+    {
+        double seconds;
+        int parameterIndex;
+        float value;
+    };
+    Array<TimedValue> automation;
+
+    String parseLine(const String& line);
+    File scriptFolder;
+};
@@ -0,0 +1,116 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SegmentRenderJob.h"
+
+namespace
+{
+    // skipSamples() takes an int, and is multiplied up by the oversampling factor
+    const int64 kMaxSkipSamples = 1 << 24;
+}
+
+SegmentRenderJob::SegmentRenderJob(const Array<AutomationEvent>& eventList, int channels,
+                                   int64 start, int64 end, double rate, int maxBlockSize)
+    : ThreadPoolJob("Render segment")
+    , events(eventList)
+    , numChannels(channels)
+    , startSample(start)
+    , endSample(end)
+    , sampleRate(rate)
+    , blockSize(maxBlockSize)
+    , position(0)
+    , nextEvent(0)
+{
+    const AudioChannelSet layout = AudioChannelSet::canonicalChannelSet(numChannels);
+    AudioProcessor::BusesLayout busesLayout;
+    busesLayout.inputBuses.add(layout);
+    busesLayout.outputBuses.add(layout);
+    processor.setBusesLayout(busesLayout);
+    processor.setNonRealtime(true);
+}
+
+ThreadPoolJob::JobStatus SegmentRenderJob::runJob()
+{
+    // the initial state must be set before prepareToPlay, which reports its latency
+    applyEventsUpTo(0);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // Output sample n is the processor's sample n + latency, as a host compensating for the
+    // plugin's latency would line it up; automation stays on the processor's timeline.
+    const int64 latency = processor.getLatencySamples();
+    const int64 renderStart = startSample + latency;
+    const int64 preRollStart = jmax((int64)0, renderStart - kPreRollSamples);
+
+    skipTo(preRollStart);
+
+    AudioBuffer<float> preRoll(numChannels, kPreRollSamples);
+    renderTo(renderStart, preRoll, preRollStart);
+
+    output.setSize(numChannels, (int)(endSample - startSample));
+    renderTo(endSample + latency, output, renderStart);
+
+    processor.releaseResources();
+    return jobHasFinished;
+}
+
+void SegmentRenderJob::applyEventsUpTo(int64 pos)
+{
+    for (; nextEvent < events.size() && events.getReference(nextEvent).samplePosition <= pos; nextEvent++)
+    {
+        const AutomationEvent& event = events.getReference(nextEvent);
+        const String id = PluginParameters::specs[event.parameterIndex].id;
+        processor.valueTreeState.getParameter(id)->setValueNotifyingHost(
+            processor.valueTreeState.getParameterRange(id).convertTo0to1(event.value));
+    }
+}
+
+void SegmentRenderJob::skipTo(int64 target)
+{
+    while (position < target)
+    {
+        applyEventsUpTo(position);
+        int64 end = jmin(target, position + kMaxSkipSamples);
+        if (nextEvent < events.size()) end = jmin(end, events.getReference(nextEvent).samplePosition);
+
+        processor.skipSamples((int)(end - position));
+        position = end;
+    }
+}
+
+// dest's sample 0 is destStartPosition on the timeline
+void SegmentRenderJob::renderTo(int64 target, AudioBuffer<float>& dest, int64 destStartPosition)
+{
+    while (position < target)
+    {
+        applyEventsUpTo(position);
+        int64 end = jmin(target, position + blockSize);
+        if (nextEvent < events.size()) end = jmin(end, events.getReference(nextEvent).samplePosition);
+
+        // render straight into dest, through a buffer referring to its channels
+        const int numSamples = (int)(end - position);
+        AudioBuffer<float> block(dest.getArrayOfWritePointers(), dest.getNumChannels(),
+                                 (int)(position - destStartPosition), numSamples);
+        processor.processBlock(block, midi);
+        position = end;
+
+        if (shouldExit()) return;
+    }
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include "RenderScript.h"
+#include "../../Source/PluginProcessor.h"
+
+// Renders one time segment of a script's output, on a ThreadPool thread, with its own
+// PluginProcessor. Segments of one output are independent: the processor is advanced to the
+// segment's start analytically (PluginProcessor::skipSamples, which is exact because the
+// oscillator's phase is a pure function of the sample position), then renders a short pre-roll
+// so the oversampling filters hold the same history they would have after a straight render.
+class SegmentRenderJob : public ThreadPoolJob
+{
+public:
+    // Output samples [startSample, endSample) are rendered into the job's own buffer, allocated
+    // when the job runs. Create on the message thread (the processor's constructor starts timers).
+    SegmentRenderJob(const Array<AutomationEvent>& events, int numChannels,
+                     int64 startSample, int64 endSample, double sampleRate, int blockSize);
+
+    JobStatus runJob() override;
+
+    // The rendered segment; valid once the job has finished
+    const AudioBuffer<float>& getOutput() const { return output; }
+
+    static const int kPreRollSamples = 1024;    // longer than the oversampler's longest filter
+
+private:
+    void applyEventsUpTo(int64 position);
+    void skipTo(int64 position);
+    void renderTo(int64 position, AudioBuffer<float>& dest, int64 destStartPosition);
+
+    const Array<AutomationEvent>& events;
+    const int numChannels;
+    AudioBuffer<float> output;
+    const int64 startSample, endSample;
+    const double sampleRate;
+    const int blockSize;
+
+    PluginProcessor processor;
+    MidiBuffer midi;
+    int64 position;         // processor's position on the timeline, in samples
+    int nextEvent;          // index of the first event not yet applied
+
+    JUCE_DECLARE_NON_COPYABLE(SegmentRenderJob)
+};
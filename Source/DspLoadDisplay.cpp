@@ -0,0 +1,82 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "DspLoadDisplay.h"
+
+static const int textHeight = 20;
+
+DspLoadDisplay::DspLoadDisplay(DspLoadMeter& meter)
+    : loadMeter(meter)
+{
+    startTimerHz(10);
+}
+
+void DspLoadDisplay::timerCallback()
+{
+    if (statistics.update(loadMeter))
+        repaint();
+}
+
+void DspLoadDisplay::mouseDown(const MouseEvent&)
+{
+    statistics.reset();
+    repaint();
+}
+
+void DspLoadDisplay::paint(Graphics& g)
+{
+    auto percent = [](float load) { return String(roundToInt(100.0f * load)) + "%"; };
+
+    Rectangle<int> area = getLocalBounds();
+    g.setColour(Colours::white);
+    g.setFont(14.0f);
+    g.drawText(TRANS("DSP load") + ": " + percent(statistics.getCurrentLoad())
+               + "  " + TRANS("peak") + " " + percent(statistics.getPeakLoad())
+               + "  p95 " + percent(statistics.getPercentileLoad(0.95f))
+               + "  p99 " + percent(statistics.getPercentileLoad(0.99f))
+               + "  " + TRANS("deadline misses") + " " + String(statistics.getNumDeadlineMisses())
+               + " / " + String(statistics.getNumBlocks()),
+               area.removeFromTop(textHeight), Justification::centredLeft);
+
+    // Histogram, one bar per bin, heights scaled to the fullest bin
+    int maxCount = 1;
+    for (int bin = 0; bin < DspLoadStatistics::kNumBins; bin++)
+        maxCount = jmax(maxCount, statistics.getBinCount(bin));
+
+    g.setColour(Colours::darkgrey);
+    g.fillRect(area);
+
+    const float barWidth = area.getWidth() / float(DspLoadStatistics::kNumBins);
+    for (int bin = 0; bin < DspLoadStatistics::kNumBins; bin++)
+    {
+        const int count = statistics.getBinCount(bin);
+        if (count == 0) continue;
+
+        // log scale, so that rare deadline misses are still visible next to the common case
+        const float height = area.getHeight() * std::log1p(float(count)) / std::log1p(float(maxCount));
+        g.setColour(bin >= DspLoadStatistics::kFirstMissBin ? Colours::red : Colours::lightgreen);
+        g.fillRect(area.getX() + bin * barWidth + 1.0f, area.getBottom() - height, barWidth - 2.0f, height);
+    }
+
+    // mark the deadline
+    g.setColour(Colours::white);
+    g.drawVerticalLine(area.getX() + roundToInt(DspLoadStatistics::kFirstMissBin * barWidth),
+                       (float)area.getY(), (float)area.getBottom());
+}
@@ -0,0 +1,43 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include "DspLoadMeter.h"
+
+// Editor component showing the processor's DSP load: current, peak and percentile load as
+// text, and a histogram of block loads with deadline misses (load above 100%) in red.
+// Polls the DspLoadMeter on its own timer; click to reset the statistics.
+class DspLoadDisplay : public Component, private Timer
+{
+public:
+    DspLoadDisplay(DspLoadMeter& meter);
+
+    void paint(Graphics&) override;
+    void mouseDown(const MouseEvent&) override;
+
+private:
+    void timerCallback() override;
+
+    DspLoadMeter& loadMeter;
+    DspLoadStatistics statistics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadDisplay)
+};
@@ -0,0 +1,99 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "DspLoadMeter.h"
+
+DspLoadMeter::DspLoadMeter()
+    : fifo(kFifoSize)
+    , ticksPerSample(0.0)
+{
+}
+
+void DspLoadMeter::prepare(double sampleRate)
+{
+    ticksPerSample = Time::getHighResolutionTicksPerSecond() / sampleRate;
+    fifo.reset();
+}
+
+void DspLoadMeter::pushBlock(int64 elapsedTicks, int numSamples)
+{
+    if (numSamples <= 0 || ticksPerSample <= 0.0) return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+    {
+        loads[start1] = float(elapsedTicks / (numSamples * ticksPerSample));
+        fifo.finishedWrite(1);
+    }
+}
+
+int DspLoadMeter::readLoads(float* dest, int maxNum)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxNum, start1, size1, start2, size2);
+    if (size1 > 0) memcpy(dest, loads + start1, size1 * sizeof(float));
+    if (size2 > 0) memcpy(dest + size1, loads + start2, size2 * sizeof(float));
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+DspLoadStatistics::DspLoadStatistics()
+{
+    reset();
+}
+
+void DspLoadStatistics::reset()
+{
+    currentLoad = peakLoad = 0.0f;
+    numBlocks = numMisses = 0;
+    for (int& count : histogram) count = 0;
+    windowCount = windowPos = 0;
+}
+
+bool DspLoadStatistics::update(DspLoadMeter& meter)
+{
+    const int numRead = meter.readLoads(readBuffer, DspLoadMeter::kFifoSize);
+    for (int i = 0; i < numRead; i++)
+    {
+        const float load = readBuffer[i];
+        peakLoad = jmax(peakLoad, load);
+        numBlocks++;
+        if (load > 1.0f) numMisses++;
+        histogram[jlimit(0, kNumBins - 1, int(load / kBinWidth))]++;
+
+        window[windowPos] = load;
+        windowPos = (windowPos + 1) % kWindowSize;
+        windowCount = jmin(windowCount + 1, kWindowSize);
+    }
+    if (numRead > 0) currentLoad = readBuffer[numRead - 1];
+    return numRead > 0;
+}
+
+float DspLoadStatistics::getPercentileLoad(float fraction) const
+{
+    if (windowCount == 0) return 0.0f;
+
+    float sorted[kWindowSize];
+    std::copy(window, window + windowCount, sorted);
+    const int n = jlimit(0, windowCount - 1, int(fraction * windowCount));
+    std::nth_element(sorted, sorted + n, sorted + windowCount);
+    return sorted[n];
+}
@@ -0,0 +1,110 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// Measures how much of each block's real-time budget processBlock uses.
+// The audio thread times each block with a ScopedTimer, which pushes the block's load
+// (processing time / block duration, so 1.0 means the deadline was just met) into a
+// lock-free single-producer, single-consumer FIFO. The message thread drains it with
+// readLoads(). Nothing on the audio side locks or allocates; if the FIFO is full because
+// nobody is reading (e.g. the editor is closed), the measurement is simply dropped.
+class DspLoadMeter
+{
+public:
+    DspLoadMeter();
+
+    // Call from prepareToPlay()
+    void prepare(double sampleRate);
+
+    // Times the enclosing scope, which renders numSamples samples, and pushes its load
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(DspLoadMeter& m, int numSamples)
+            : meter(m), startTicks(Time::getHighResolutionTicks()), blockSamples(numSamples) {}
+        ~ScopedTimer() { meter.pushBlock(Time::getHighResolutionTicks() - startTicks, blockSamples); }
+
+    private:
+        DspLoadMeter& meter;
+        const int64 startTicks;
+        const int blockSamples;
+    };
+
+    // Message thread: copies up to maxNum pending loads into dest, returns the number copied
+    int readLoads(float* dest, int maxNum);
+
+    static const int kFifoSize = 1024;
+
+private:
+    void pushBlock(int64 elapsedTicks, int numSamples);
+
+    AbstractFifo fifo;
+    float loads[kFifoSize];
+
+    // high-resolution ticks per sample, i.e. the real-time budget of one sample
+    double ticksPerSample;
+
+    JUCE_DECLARE_NON_COPYABLE(DspLoadMeter)
+};
+
+// Message-thread statistics over the loads read from a DspLoadMeter:
+// current and peak load, percentiles over a window of recent blocks, and a histogram
+// whose bins above 1.0 count deadline misses by how badly the deadline was missed.
+class DspLoadStatistics
+{
+public:
+    DspLoadStatistics();
+
+    // Drains the meter and updates all statistics; returns true if any new loads were read
+    bool update(DspLoadMeter& meter);
+    void reset();
+
+    float getCurrentLoad() const { return currentLoad; }
+    float getPeakLoad() const { return peakLoad; }
+
+    // e.g. getPercentileLoad(0.99f) over the most recent kWindowSize blocks
+    float getPercentileLoad(float fraction) const;
+
+    int getNumBlocks() const { return numBlocks; }
+    int getNumDeadlineMisses() const { return numMisses; }
+
+    // Histogram of block loads, kNumBins bins of kBinWidth each; the last bin also counts
+    // everything beyond it. Bins from kFirstMissBin up are deadline misses.
+    int getBinCount(int bin) const { return histogram[bin]; }
+    static float getBinStartLoad(int bin) { return bin * kBinWidth; }
+
+    static const int kWindowSize = 2048;
+    static const int kNumBins = 20;
+    static constexpr float kBinWidth = 0.1f;
+    static const int kFirstMissBin = 10;
+
+private:
+    float readBuffer[DspLoadMeter::kFifoSize];
+
+    float currentLoad, peakLoad;
+    int numBlocks, numMisses;
+    int histogram[kNumBins];
+
+    // ring of the most recent loads, for percentiles
+    float window[kWindowSize];
+    int windowCount, windowPos;
+};
@@ -0,0 +1,107 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "ParameterBulkLoader.h"
+
+ParameterBulkLoader::ParameterBulkLoader(AudioProcessorValueTreeState& vts, const StringArray& parameterIds)
+    : valueTreeState(vts)
+{
+    for (int i = 0; i < parameterIds.size(); i++)
+    {
+        AudioProcessorParameterWithID* param = vts.getParameter(parameterIds[i]);
+        jassert(param != nullptr);   // parameters must be created before the loader
+        indexById.set(parameterIds[i], i);
+        parameters.add(param);
+        ranges.add(vts.getParameterRange(parameterIds[i]));
+    }
+}
+
+int ParameterBulkLoader::indexOf(const String& parameterId) const
+{
+    return indexById.contains(parameterId) ? indexById[parameterId] : -1;
+}
+
+bool ParameterBulkLoader::setNormalisedValue(int index, float newValue)
+{
+    AudioProcessorParameterWithID* param = parameters.getUnchecked(index);
+    if (param == nullptr || param->getValue() == newValue) return false;
+
+    param->setValue(newValue);
+    return true;
+}
+
+void ParameterBulkLoader::notifyBatchChanged()
+{
+    valueTreeState.processor.updateHostDisplay();
+    sendChangeMessage();
+}
+
+int ParameterBulkLoader::applyValues(const NamedValueSet& values)
+{
+    int numChanged = 0;
+    for (int i = 0; i < values.size(); i++)
+    {
+        const String id = values.getName(i).toString();
+        int index = indexOf(id);
+        if (index < 0) continue;
+
+        const NormalisableRange<float>& range = ranges.getReference(index);
+        float value = range.snapToLegalValue((float)values.getValueAt(i));
+        if (setNormalisedValue(index, range.convertTo0to1(value))) numChanged++;
+    }
+
+    // one coalesced notification for the whole batch
+    if (numChanged > 0) notifyBatchChanged();
+    return numChanged;
+}
+
+int ParameterBulkLoader::applyValues(const float* values, int numValues)
+{
+    int numChanged = 0;
+    const int n = jmin(numValues, parameters.size());
+    for (int i = 0; i < n; i++)
+    {
+        const NormalisableRange<float>& range = ranges.getReference(i);
+        if (setNormalisedValue(i, range.convertTo0to1(range.snapToLegalValue(values[i])))) numChanged++;
+    }
+
+    // one coalesced notification for the whole batch
+    if (numChanged > 0) notifyBatchChanged();
+    return numChanged;
+}
+
+void ParameterBulkLoader::getNormalisedValues(float* values, int numValues) const
+{
+    const int n = jmin(numValues, parameters.size());
+    for (int i = 0; i < n; i++)
+        values[i] = parameters.getUnchecked(i)->getValue();
+}
+
+int ParameterBulkLoader::applyNormalisedValues(const float* values, int numValues)
+{
+    int numChanged = 0;
+    const int n = jmin(numValues, parameters.size());
+    for (int i = 0; i < n; i++)
+        if (setNormalisedValue(i, jlimit(0.0f, 1.0f, values[i]))) numChanged++;
+
+    // one coalesced notification for the whole batch
+    if (numChanged > 0) notifyBatchChanged();
+    return numChanged;
+}
@@ -0,0 +1,69 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// Applies many parameter values to an AudioProcessorValueTreeState at once, e.g. when restoring
+// state or loading a preset.
+// Parameter ids are resolved through a hash index built once at construction, and values are
+// written directly to the parameter objects with setValue() (skipping any which are unchanged),
+// rather than one at a time through getParameterAsValue(), which goes via the ValueTree, or
+// setValueNotifyingHost(), which notifies the host of each one. The parameters' own listeners
+// still see each value (they keep the working values), but the host and the GUI are notified
+// once for the whole batch: updateHostDisplay() makes the host re-read every parameter, and one
+// change message is sent to registered ChangeListeners (e.g. the editor's controls).
+class ParameterBulkLoader : public ChangeBroadcaster
+{
+public:
+    // parameterIds must all have been added to vts already
+    ParameterBulkLoader(AudioProcessorValueTreeState& vts, const StringArray& parameterIds);
+
+    // Index of the given parameter id in the list passed to the constructor, or -1
+    int indexOf(const String& parameterId) const;
+
+    int getNumParameters() const { return parameters.size(); }
+
+    // Apply (parameter id, un-normalised value) pairs; unknown ids are ignored.
+    // Returns the number of parameters whose values changed.
+    int applyValues(const NamedValueSet& values);
+
+    // Apply un-normalised values, one per parameter, in constructor order.
+    // Returns the number of parameters whose values changed.
+    int applyValues(const float* values, int numValues);
+
+    // Get current normalised (0..1) values, one per parameter, in constructor order
+    void getNormalisedValues(float* values, int numValues) const;
+
+    // Apply normalised (0..1) values, one per parameter, in constructor order.
+    // Returns the number of parameters whose values changed.
+    int applyNormalisedValues(const float* values, int numValues);
+
+private:
+    AudioProcessorValueTreeState& valueTreeState;
+    HashMap<String, int> indexById;
+    Array<AudioProcessorParameterWithID*> parameters;
+    Array<NormalisableRange<float>> ranges;     // by index, so applying values needs no id lookups
+
+    bool setNormalisedValue(int index, float newValue);
+    void notifyBatchChanged();
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterBulkLoader)
+};
@@ -0,0 +1,173 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "ParameterControlDispatcher.h"
+
+ParameterControlDispatcher::ParameterControlDispatcher(AudioProcessorValueTreeState& vts, ParameterBulkLoader& loader,
+                                                       Component* const controlList[kNumParameters])
+    : valueTreeState(vts)
+    , bulkLoader(loader)
+{
+    for (auto& word : dirtyBits) word = ~0u;    // show every value at first
+
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[i];
+        controls[i] = controlList[i];
+        params[i] = valueTreeState.getParameter(spec.id);
+        values[i] = valueTreeState.getRawParameterValue(spec.id);
+
+        switch (spec.type)
+        {
+        case kChoiceParameter:
+            static_cast<ComboBox*>(controls[i])->addListener(this);
+            break;
+        case kIntegerParameter:
+        case kFloatParameter:
+        {
+            Slider* slider = static_cast<Slider*>(controls[i]);
+            slider->setRange(spec.minValue, spec.maxValue, spec.interval);
+            slider->setDoubleClickReturnValue(true, spec.defaultValue);
+            slider->textFromValueFunction = [i](double value) { return PluginParameters::getText(i, (float)value); };
+            slider->valueFromTextFunction = [i](const String& text) { return (double)PluginParameters::getValueForText(i, text); };
+            slider->addListener(this);
+            break;
+        }
+        case kBoolParameter:
+            static_cast<Button*>(controls[i])->addListener(this);
+            break;
+        }
+
+        listeners[i].owner = this;
+        listeners[i].index = i;
+        valueTreeState.addParameterListener(spec.id, &listeners[i]);
+    }
+
+    bulkLoader.addChangeListener(this);
+
+    timerCallback();
+    startTimerHz(kFrameRateHz);
+}
+
+ParameterControlDispatcher::~ParameterControlDispatcher()
+{
+    stopTimer();
+    bulkLoader.removeChangeListener(this);
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        valueTreeState.removeParameterListener(PluginParameters::specs[i].id, &listeners[i]);
+
+        switch (PluginParameters::specs[i].type)
+        {
+        case kChoiceParameter: static_cast<ComboBox*>(controls[i])->removeListener(this); break;
+        case kIntegerParameter:
+        case kFloatParameter: static_cast<Slider*>(controls[i])->removeListener(this); break;
+        case kBoolParameter: static_cast<Button*>(controls[i])->removeListener(this); break;
+        }
+    }
+}
+
+void ParameterControlDispatcher::timerCallback()
+{
+    for (int w = 0; w < kNumDirtyWords; w++)
+    {
+        uint32 bits = dirtyBits[w].exchange(0, std::memory_order_acquire);
+        for (int b = 0; bits != 0; b++, bits >>= 1)
+            if ((bits & 1) != 0 && w * 32 + b < kNumParameters)
+                updateControl(w * 32 + b);
+    }
+}
+
+void ParameterControlDispatcher::changeListenerCallback(ChangeBroadcaster*)
+{
+    // a whole batch of values changed: show them all now, rather than at the next frame
+    for (auto& word : dirtyBits) word = ~0u;
+    timerCallback();
+}
+
+void ParameterControlDispatcher::updateControl(int index)
+{
+    // dontSendNotification, so this does not come back as an edit
+    const float value = *values[index];
+    switch (PluginParameters::specs[index].type)
+    {
+    case kChoiceParameter:
+        static_cast<ComboBox*>(controls[index])->setSelectedId(roundToInt(value) + 1, dontSendNotification);
+        break;
+    case kIntegerParameter:
+    case kFloatParameter:
+    {
+        Slider* slider = static_cast<Slider*>(controls[index]);
+        if (slider->getValue() != value) slider->setValue(value, dontSendNotification);
+        break;
+    }
+    case kBoolParameter:
+        static_cast<Button*>(controls[index])->setToggleState(value >= 0.5f, dontSendNotification);
+        break;
+    }
+}
+
+int ParameterControlDispatcher::indexOf(Component* control) const
+{
+    for (int i = 0; i < kNumParameters; i++)
+        if (controls[i] == control) return i;
+    return -1;
+}
+
+void ParameterControlDispatcher::setParameter(int index, float value, bool asGesture)
+{
+    if (index < 0) return;
+
+    const float normalised = valueTreeState.getParameterRange(PluginParameters::specs[index].id).convertTo0to1(value);
+    if (params[index]->getValue() == normalised) return;
+
+    if (asGesture) params[index]->beginChangeGesture();
+    params[index]->setValueNotifyingHost(normalised);
+    if (asGesture) params[index]->endChangeGesture();
+}
+
+void ParameterControlDispatcher::sliderValueChanged(Slider* slider)
+{
+    // a drag is already inside the gesture begun by sliderDragStarted()
+    setParameter(indexOf(slider), (float)slider->getValue(), !slider->isMouseButtonDown());
+}
+
+void ParameterControlDispatcher::sliderDragStarted(Slider* slider)
+{
+    const int index = indexOf(slider);
+    if (index >= 0) params[index]->beginChangeGesture();
+}
+
+void ParameterControlDispatcher::sliderDragEnded(Slider* slider)
+{
+    const int index = indexOf(slider);
+    if (index >= 0) params[index]->endChangeGesture();
+}
+
+void ParameterControlDispatcher::comboBoxChanged(ComboBox* combo)
+{
+    if (combo->getSelectedId() > 0)
+        setParameter(indexOf(combo), (float)(combo->getSelectedId() - 1), true);
+}
+
+void ParameterControlDispatcher::buttonClicked(Button* button)
+{
+    setParameter(indexOf(button), button->getToggleState() ? 1.0f : 0.0f, true);
+}
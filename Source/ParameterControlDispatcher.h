@@ -0,0 +1,90 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include "PluginParameters.h"
+#include "ParameterBulkLoader.h"
+#include <atomic>
+
+// Keeps an editor's controls and the parameters in step, in place of one APVTS attachment per
+// control. A parameter change, on whatever thread makes it, only sets the parameter's bit in a
+// lock-free dirty set; a timer at the display frame rate then updates every changed control in
+// one pass on the message thread. However dense the automation, each control is updated at
+// most once per frame, and nothing is posted to the message queue per change.
+// Edits made with the controls are written to the parameters inside change gestures (also for
+// typed or keyboard edits, which attachments wrote without one), so each edit is one undo step.
+// A batch of values applied by the ParameterBulkLoader (state restore, preset load) refreshes
+// every control at once, on the loader's single change message.
+class ParameterControlDispatcher : private Slider::Listener, private ComboBox::Listener,
+                                   private Button::Listener, private Timer, private ChangeListener
+{
+public:
+    // Takes one control per parameter, by ParameterIndex: a ComboBox (with item ids of value + 1)
+    // for choice parameters, a Slider for integer and float parameters, and a ToggleButton for
+    // bool parameters. Sets up slider ranges and text conversion, and shows the current values.
+    ParameterControlDispatcher(AudioProcessorValueTreeState& vts, ParameterBulkLoader& loader,
+                               Component* const controls[kNumParameters]);
+    ~ParameterControlDispatcher();
+
+    static const int kFrameRateHz = 60;
+
+private:
+    // AudioProcessorValueTreeState::Listener which marks one parameter dirty
+    struct DirtyFlagListener : public AudioProcessorValueTreeState::Listener
+    {
+        ParameterControlDispatcher* owner;
+        int index;
+
+        DirtyFlagListener() : owner(nullptr), index(0) {}
+        void parameterChanged(const String&, float) override { owner->markDirty(index); }
+    };
+
+    void markDirty(int index)
+    {
+        dirtyBits[index / 32].fetch_or(1u << (index % 32), std::memory_order_release);
+    }
+
+    // Update all controls whose parameters changed since the last frame
+    void timerCallback() override;
+    void updateControl(int index);
+    void changeListenerCallback(ChangeBroadcaster*) override;
+
+    // Control edits
+    void sliderValueChanged(Slider*) override;
+    void sliderDragStarted(Slider*) override;
+    void sliderDragEnded(Slider*) override;
+    void comboBoxChanged(ComboBox*) override;
+    void buttonClicked(Button*) override;
+    int indexOf(Component* control) const;
+    void setParameter(int index, float value, bool asGesture);
+
+    AudioProcessorValueTreeState& valueTreeState;
+    ParameterBulkLoader& bulkLoader;
+    Component* controls[kNumParameters];
+    AudioProcessorParameterWithID* params[kNumParameters];
+    float* values[kNumParameters];          // current un-normalised values
+
+    static const int kNumDirtyWords = (kNumParameters + 31) / 32;
+    std::atomic<uint32> dirtyBits[kNumDirtyWords];
+
+    DirtyFlagListener listeners[kNumParameters];
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterControlDispatcher)
+};
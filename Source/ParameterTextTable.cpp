@@ -0,0 +1,132 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "ParameterTextTable.h"
+
+ParameterTextTable::ParameterTextTable(const ParameterSpec& spec)
+    : minValue(spec.minValue)
+    , interval(spec.interval)
+{
+    jassert(interval > 0.0f);
+    const int numSteps = roundToInt((spec.maxValue - spec.minValue) / interval) + 1;
+    for (int i = 0; i < numSteps; i++)
+        texts.add(spec.valueToText(minValue + i * interval));
+
+    // about one key per bucket, and at most half the slots filled
+    const int numBuckets = nextPowerOfTwo(numSteps);
+    const int numSlots = 2 * numBuckets;
+    bucketMask = (uint32)numBuckets - 1;
+    slotMask = (uint32)numSlots - 1;
+    displacements.calloc((size_t)numBuckets);
+    slots.malloc((size_t)numSlots);
+    for (int s = 0; s < numSlots; s++) slots[s] = -1;
+
+    Array<uint32> hashes;
+    Array<Array<int>> buckets;
+    buckets.resize(numBuckets);
+    for (int i = 0; i < numSteps; i++)
+    {
+        hashes.add(hashText(texts[i].toRawUTF8()));
+
+        // a repeated text parses to its first step (and could never get a slot of its own)
+        if (texts.indexOf(texts[i]) == i)
+            buckets.getReference((int)(hashes[i] & bucketMask)).add(i);
+    }
+
+    // place the largest buckets first, while the slots are emptiest
+    Array<int> order;
+    for (int b = 0; b < numBuckets; b++) order.add(b);
+    std::sort(order.begin(), order.end(), [&buckets](int a, int b) { return buckets[a].size() > buckets[b].size(); });
+
+    for (int b : order)
+    {
+        const Array<int>& keys = buckets.getReference(b);
+        if (keys.isEmpty()) break;
+
+        for (uint32 d = 0;; d++)
+        {
+            Array<int> placed;
+            for (int key : keys)
+            {
+                const int s = (int)(slotHash(hashes[key], d) & slotMask);
+                if (slots[s] >= 0 || placed.contains(s)) break;
+                placed.add(s);
+            }
+            if (placed.size() < keys.size()) continue;
+
+            for (int k = 0; k < keys.size(); k++) slots[placed[k]] = keys[k];
+            displacements[b] = d;
+            break;
+        }
+    }
+}
+
+const String& ParameterTextTable::getText(float value) const
+{
+    const int step = jlimit(0, texts.size() - 1, roundToInt((value - minValue) / interval));
+    return texts.getReference(step);
+}
+
+bool ParameterTextTable::parse(const String& text, float& value) const
+{
+    const uint32 h = hashText(text.toRawUTF8());
+    const int step = slots[slotHash(h, displacements[h & bucketMask]) & slotMask];
+    if (step < 0 || texts.getReference(step) != text) return false;
+
+    value = minValue + step * interval;
+    return true;
+}
+
+uint32 ParameterTextTable::hashText(const char* utf8)
+{
+    // 32-bit FNV-1a
+    uint32 h = 2166136261u;
+    for (; *utf8 != 0; utf8++) h = (h ^ (uint8)*utf8) * 16777619u;
+    return h;
+}
+
+uint32 ParameterTextTable::slotHash(uint32 textHash, uint32 displacement)
+{
+    // murmur3 finalizer, so slots are independent of the low bits which chose the bucket
+    uint32 h = textHash + displacement * 0x9e3779b9u;
+    h ^= h >> 16; h *= 0x85ebca6bu;
+    h ^= h >> 13; h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+const ParameterTextTable* ParameterTextTable::get(int parameterIndex)
+{
+    // built on first use (thread-safe), shared by all instances
+    struct Tables
+    {
+        ScopedPointer<ParameterTextTable> tables[kNumParameters];
+
+        Tables()
+        {
+            for (int i = 0; i < kNumParameters; i++)
+                if (PluginParameters::specs[i].type != kFloatParameter)
+                    tables[i] = new ParameterTextTable(PluginParameters::specs[i]);
+        }
+    };
+    static const Tables shared;
+
+    return isPositiveAndBelow(parameterIndex, (int)kNumParameters) ? shared.tables[parameterIndex].get() : nullptr;
+}
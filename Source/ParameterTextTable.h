@@ -0,0 +1,59 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include "PluginParameters.h"
+
+// Display text of every value of a stepped (choice, integer or bool) parameter, built once
+// from its ParameterSpec and shared by all plugin instances, so hosts polling getText()
+// get a reference-counted copy of a prebuilt String instead of a newly formatted one.
+// Text is parsed back through a minimal perfect hash of the table's texts (hash and
+// displace: a first hash picks a bucket, whose displacement gives a collision-free slot),
+// i.e. one hash and one string compare, with no allocation.
+class ParameterTextTable
+{
+public:
+    explicit ParameterTextTable(const ParameterSpec& spec);
+
+    int getNumSteps() const { return texts.size(); }
+
+    // Text of the step nearest to value
+    const String& getText(float value) const;
+
+    // If text is exactly the text of one step, set value to that step's value and return true
+    bool parse(const String& text, float& value) const;
+
+    // Shared table of the given parameter, or nullptr if it is not stepped
+    static const ParameterTextTable* get(int parameterIndex);
+
+private:
+    float minValue, interval;
+    StringArray texts;
+
+    // perfect hash: bucket -> displacement, then slot -> step index (-1 if empty)
+    HeapBlock<uint32> displacements;
+    HeapBlock<int> slots;
+    uint32 bucketMask, slotMask;
+
+    static uint32 hashText(const char* utf8);
+    static uint32 slotHash(uint32 textHash, uint32 displacement);
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterTextTable)
+};
@@ -21,16 +21,28 @@ THE SOFTWARE.
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+// Layout constants
+static const int labelLeft = 16;
+static const int controlLeft = 144;
+static const int labelWidth = 120;
+static const int cboxWidth = 150;
+static const int sliderWidth = 420;
+static const int toggleWidth = 24;
+static const int buttonWidth = 80;
+static const int buttonGap = 20;
+static const int controlHeight = 24;
+static const int gapHeight = 8;
+static const int topMargin = 20;
+static const int loadDisplayHeight = 100;
+static const int scopeDisplayHeight = 140;
+
 PluginEditor::PluginEditor (PluginProcessor& p)
     : AudioProcessorEditor(&p)
     , processor(p)
-    , parameters(p.parameters)
-    , waveformLabel(PluginParameters::waveform_Id, PluginParameters::waveform_Name)
-    , noteNumberLabel(PluginParameters::midiNoteNumber_Id, PluginParameters::midiNoteNumber_Name)
-    , levelLabel(PluginParameters::level_Id, PluginParameters::level_Name)
-    , loudLabel(PluginParameters::loud_Id, PluginParameters::loud_Name)
     , undoButton(TRANS("Undo"))
     , redoButton(TRANS("Redo"))
+    , loadDisplay(p.loadMeter)
+    , scopeDisplay(p.scopeBuffer)
 {
     auto initLabel = [this](Label& label)
     {
@@ -42,23 +54,17 @@ PluginEditor::PluginEditor (PluginProcessor& p)
         label.setColour(TextEditor::backgroundColourId, Colour(0x00000000));
     };
 
-    initLabel(waveformLabel);
-    initLabel(noteNumberLabel);
-    initLabel(levelLabel);
-    initLabel(loudLabel);
-
-    auto initCombo = [this](ComboBox& combo)
+    auto initCombo = [this](ComboBox& combo, const ParameterSpec& spec)
     {
         addAndMakeVisible(combo);
         combo.setEditableText(false);
         combo.setJustificationType(Justification::centredLeft);
         combo.setTextWhenNothingSelected("");
         combo.setTextWhenNoChoicesAvailable(TRANS("(no choices)"));
+        for (int i = (int)spec.minValue; i <= (int)spec.maxValue; i++)
+            combo.addItem(spec.valueToText((float)i), i + 1);
     };
 
-    initCombo(waveformCombo);
-    SynthWaveform::setupComboBox(waveformCombo);
-
     auto initSlider = [this](Slider& slider)
     {
         addAndMakeVisible(slider);
@@ -66,34 +72,51 @@ PluginEditor::PluginEditor (PluginProcessor& p)
         slider.setTextBoxStyle(Slider::TextBoxRight, false, 80, 20);
     };
 
-    initSlider(noteNumberSlider); //noteNumberSlider.setRange(0, 127, 1);
-    initSlider(levelSlider); //levelSlider.setRange(0, 1, 0);
-
     auto initToggle = [this](ToggleButton& toggle)
     {
         addAndMakeVisible(toggle);
     };
 
-    initToggle(loudToggle);
+    // Create a label and a suitable control for every parameter in the table
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        const ParameterSpec& spec = PluginParameters::specs[i];
+
+        Label* label = labels.add(new Label(spec.id, TRANS(spec.name)));
+        initLabel(*label);
+
+        switch (spec.type)
+        {
+        case kChoiceParameter:
+            initCombo(*static_cast<ComboBox*>(controls.add(new ComboBox())), spec);
+            break;
+        case kIntegerParameter:
+        case kFloatParameter:
+            initSlider(*static_cast<Slider*>(controls.add(new Slider())));
+            break;
+        case kBoolParameter:
+            initToggle(*static_cast<ToggleButton*>(controls.add(new ToggleButton())));
+            break;
+        }
+    }
 
-    // Note slider attachments will set slider ranges automatically
-    parameters.attachControls(waveformCombo, noteNumberSlider, levelSlider, loudToggle);
+    // The dispatcher sets slider ranges, and shows the current values
+    dispatcher = new ParameterControlDispatcher(processor.valueTreeState, processor.parameters.getBulkLoader(),
+                                                controls.getRawDataPointer());
 
     addAndMakeVisible(undoButton);
     addAndMakeVisible(redoButton);
     undoButton.addListener(this);
     redoButton.addListener(this);
 
-    // clear the undo manager now, because this is our starting point
-    // (Setting up the ValueTree will have added many actions to the history, which 
-    // aren't actually supposed to be undoable.)
-    processor.undoManager.clearUndoHistory();
+    addAndMakeVisible(loadDisplay);
+    addAndMakeVisible(scopeDisplay);
 
     // execute timer callback once immediately, then every 500ms thereafter
     timerCallback();
     startTimer(500);
 
-    setSize (600, 200);
+    setSize (600, 2 * topMargin + (kNumParameters + 1) * (controlHeight + gapHeight) + loadDisplayHeight + scopeDisplayHeight);
 }
 
 void PluginEditor::paint (Graphics& g)
@@ -103,32 +126,23 @@ void PluginEditor::paint (Graphics& g)
 
 void PluginEditor::resized()
 {
-    const int labelLeft = 16;
-    const int controlLeft = 144;
-    const int labelWidth = 120;
-    const int cboxWidth = 150;
-    const int sliderWidth = 420;
-    const int toggleWidth = 24;
-    const int buttonWidth = 80;
-    const int buttonGap = 20;
-    const int controlHeight = 24;
-    const int gapHeight = 8;
-
-    int top = 20;
-    waveformLabel.setBounds(labelLeft, top, labelWidth, controlHeight);
-    waveformCombo.setBounds(controlLeft, top, cboxWidth, controlHeight);
-    top += controlHeight + gapHeight;
-    noteNumberLabel.setBounds(labelLeft, top, labelWidth, controlHeight);
-    noteNumberSlider.setBounds(controlLeft, top, sliderWidth, controlHeight);
-    top += controlHeight + gapHeight;
-    levelLabel.setBounds(labelLeft, top, labelWidth, controlHeight);
-    levelSlider.setBounds(controlLeft, top, sliderWidth, controlHeight);
-    top += controlHeight + gapHeight;
-    loudLabel.setBounds(labelLeft, top, labelWidth, controlHeight);
-    loudToggle.setBounds(controlLeft, top, toggleWidth, controlHeight);
-    top += controlHeight + gapHeight;
+    int top = topMargin;
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        int controlWidth = sliderWidth;
+        if (PluginParameters::specs[i].type == kChoiceParameter) controlWidth = cboxWidth;
+        else if (PluginParameters::specs[i].type == kBoolParameter) controlWidth = toggleWidth;
+
+        labels[i]->setBounds(labelLeft, top, labelWidth, controlHeight);
+        controls[i]->setBounds(controlLeft, top, controlWidth, controlHeight);
+        top += controlHeight + gapHeight;
+    }
     undoButton.setBounds(controlLeft, top, buttonWidth, controlHeight);
     redoButton.setBounds(controlLeft + buttonWidth + buttonGap, top, buttonWidth, controlHeight);
+    top += controlHeight + gapHeight;
+    loadDisplay.setBounds(labelLeft, top, getWidth() - 2 * labelLeft, loadDisplayHeight - gapHeight);
+    top += loadDisplayHeight;
+    scopeDisplay.setBounds(labelLeft, top, getWidth() - 2 * labelLeft, scopeDisplayHeight - gapHeight);
 }
 
 void PluginEditor::buttonClicked(Button* button)
@@ -145,11 +159,7 @@ void PluginEditor::buttonClicked(Button* button)
 
 void PluginEditor::timerCallback()
 {
-    // Doing this on a timed basis is copied from the JUCE ValueTreesDemo, but it's not an ideal
-    // approach because we don't want to start new transactions in the middle of an update gesture
-    // like dragging a slider.
-    processor.undoManager.beginNewTransaction();
-
+    // Undo transactions are recorded by the processor's UndoTransactionTracker, per gesture
     undoButton.setEnabled(processor.undoManager.canUndo());
     redoButton.setEnabled(processor.undoManager.canRedo());
 }
\ No newline at end of file
@@ -20,9 +20,12 @@ THE SOFTWARE.
 */
 #pragma once
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "PluginParameters.h"
+#include "DspLoadDisplay.h"
+#include "ScopeDisplay.h"
+#include "ParameterControlDispatcher.h"
 
 class PluginProcessor;
 
@@ -30,7 +33,6 @@ class PluginEditor  : public AudioProcessorEditor, private Button::Listener, pri
 {
 public:
     PluginEditor (PluginProcessor&);
-    ~PluginEditor() { parameters.detachControls(); }
 
     void paint (Graphics&) override;
     void resized() override;
@@ -41,19 +43,18 @@ private:
     void timerCallback() override;
 
     PluginProcessor& processor;
-    PluginParameters& parameters;
 
-    Label waveformLabel;
-    ComboBox waveformCombo;
-    Label noteNumberLabel;
-    Slider noteNumberSlider;
+    // One label and one control per parameter, by ParameterIndex, generated from the parameter table
+    OwnedArray<Label> labels;
+    OwnedArray<Component> controls;
 
-    Label levelLabel;
-    Slider levelSlider;
-    Label loudLabel;
-    ToggleButton loudToggle;
+    // Keeps the controls and the parameters in step, at most once per display frame
+    ScopedPointer<ParameterControlDispatcher> dispatcher;
 
     TextButton undoButton, redoButton;
 
+    DspLoadDisplay loadDisplay;
+    ScopeDisplay scopeDisplay;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginEditor)
 };
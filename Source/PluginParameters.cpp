@@ -19,136 +19,280 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "PluginParameters.h"
+#include "ParameterTextTable.h"
 
-// Names are symbolic names used to tag AudioParameter objects and XML attributes
-// Labels are human-friendly identifiers for use in GUIs
-const String PluginParameters::waveform_Id = "waveform";
-const String PluginParameters::waveform_Name = TRANS("Waveform");
-const String PluginParameters::waveform_Label;
-const String PluginParameters::midiNoteNumber_Id = "midiNoteNumber";
-const String PluginParameters::midiNoteNumber_Name = TRANS("Midi Note Number");
-const String PluginParameters::midiNoteNumber_Label;
-const String PluginParameters::level_Id = "level";
-const String PluginParameters::level_Name = TRANS("Level");
-const String PluginParameters::level_Label = TRANS("/10");
-const String PluginParameters::loud_Id = "loud";
-const String PluginParameters::loud_Name = TRANS("Loud");
-const String PluginParameters::loud_Label;
+// Definition of the parameter table (declared and initialized in the header)
+constexpr ParameterSpec PluginParameters::specs[kNumParameters];
+
+String PluginParameters::noteNumberToText(float value)
+{
+    return MidiMessage::getMidiNoteName((int)value, true, true, 4);
+}
+
+String PluginParameters::numberToText(float value)
+{
+    return String(value);
+}
+
+float PluginParameters::numberFromText(const String& text)
+{
+    return text.getFloatValue();
+}
+
+String PluginParameters::boolToText(float value)
+{
+    return value < 0.5f ? "no" : "yes";
+}
+
+float PluginParameters::boolFromText(const String& text)
+{
+    return text == "yes" ? 1.0f : 0.0f;
+}
+
+String PluginParameters::oversamplingToText(float value)
+{
+    return String(1 << (int)(value + 0.5f)) + "x";
+}
+
+float PluginParameters::oversamplingFromText(const String& text)
+{
+    // "1x", "2x", "4x", "8x" -> 0..3
+    int factor = text.getIntValue();
+    int log2 = 0;
+    while (factor > 1 && log2 < 3) { factor >>= 1; log2++; }
+    return (float)log2;
+}
+
+String PluginParameters::getText(int parameterIndex, float value)
+{
+    if (const ParameterTextTable* table = ParameterTextTable::get(parameterIndex))
+        return table->getText(value);
+    return specs[parameterIndex].valueToText(value);
+}
+
+float PluginParameters::getValueForText(int parameterIndex, const String& text)
+{
+    float value;
+    const ParameterTextTable* table = ParameterTextTable::get(parameterIndex);
+    if (table != nullptr && table->parse(text, value)) return value;
+    return specs[parameterIndex].textToValue(text);
+}
+
+float PluginParameters::toWorkingValue(const ParameterSpec& spec, float parameterValue)
+{
+    switch (spec.type)
+    {
+    case kChoiceParameter:
+        return (float)(int)(parameterValue + 0.5f);
+    case kIntegerParameter:
+        return (float)(int)parameterValue;
+    case kFloatParameter:
+        return spec.workingScale * parameterValue;
+    case kBoolParameter:
+        return parameterValue >= 0.5f ? 1.0f : 0.0f;
+    }
+    return parameterValue;
+}
 
 PluginParameters::PluginParameters(AudioProcessorValueTreeState& vts)
     : valueTreeState(vts)
-    , pWaveformAttachment(nullptr)
-    , pNoteNumberAttachment(nullptr)
-    , pLevelAttachment(nullptr)
-    , pLoudAttachment(nullptr)
-    , waveformListener(waveform)
-    , noteNumberListener(midiNoteNumber)
-    , levelListener(level, 0.1f)
-    , loudListener(loud)
-{
-    // Set default values of working values
-    // waveform already defaults to "Sine"
-    level = 0.5f;
-    loud = false;
-    midiNoteNumber = 60;
+{
+    // Set default values of working values, and connect each listener to its working value
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        workingValues[i] = toWorkingValue(specs[i], specs[i].defaultValue);
+        listeners[i].workingValue = &workingValues[i];
+        listeners[i].spec = &specs[i];
+        rawValues[i] = nullptr;
+    }
 }
 
 void PluginParameters::createAllParameters()
 {
-    // waveform: choice out of 4 possibilities, values 0..3
-    valueTreeState.createAndAddParameter(waveform_Id, waveform_Name, waveform_Label,
-        NormalisableRange<float>(0.0f, (float)(SynthWaveform::kChoices - 1), 1.0f),
-        (float)waveform.getIndex(),
-        SynthWaveform::floatToText,
-        SynthWaveform::textToFloat);
-    valueTreeState.addParameterListener(waveform_Id, &waveformListener);
-
-    // note number: integer parameter, range 0..127
-    valueTreeState.createAndAddParameter(midiNoteNumber_Id, midiNoteNumber_Name, midiNoteNumber_Label,
-        NormalisableRange<float>(0.0f, 127.0f, 1.0f),
-        (float)midiNoteNumber,
-        [](float value) { return MidiMessage::getMidiNoteName((int)value, true, true, 4); },
-        [](const String& text) { return text.getFloatValue(); });
-    valueTreeState.addParameterListener(midiNoteNumber_Id, &noteNumberListener);
-
-    // level: float parameter, range 0.0-1.0, shown as 0.0-10.0 (scaled x10)
-    valueTreeState.createAndAddParameter(level_Id, level_Name, level_Label,
-        NormalisableRange<float>(0.0f, 10.0f),
-        level,
-        [](float value) { return String(value); },
-        [](const String& text) { return text.getFloatValue(); } );
-    valueTreeState.addParameterListener(level_Id, &levelListener);
-
-    // loud: boolean parameter, range 0.0-1.0, show as "yes" or "no"
-    valueTreeState.createAndAddParameter(loud_Id, loud_Name, loud_Label,
-        NormalisableRange<float>(0.0f, 1.0f, 1.0f),
-        loud ? 1.0f : 0.0f,
-        [](float value) { return value < 0.5f ? "no" : "yes"; },
-        [](const String& text) { return text == "yes" ? 1.0f : 0.0f; } );
-    valueTreeState.addParameterListener(loud_Id, &loudListener);
-}
-
-void PluginParameters::detachControls()
-{
-    if (pWaveformAttachment != nullptr)
+    StringArray ids;
+    for (int i = 0; i < kNumParameters; i++)
     {
-        delete pWaveformAttachment;
-        pWaveformAttachment = nullptr;
+        const ParameterSpec& spec = specs[i];
+        valueTreeState.createAndAddParameter(spec.id, TRANS(spec.name), TRANS(spec.label),
+            NormalisableRange<float>(spec.minValue, spec.maxValue, spec.interval),
+            spec.defaultValue,
+            [i](float value) { return getText(i, value); },
+            [i](const String& text) { return getValueForText(i, text); });
+        valueTreeState.addParameterListener(spec.id, &listeners[i]);
+        rawValues[i] = valueTreeState.getRawParameterValue(spec.id);
+        ids.add(spec.id);
     }
-    if (pNoteNumberAttachment != nullptr)
+
+    bulkLoader = new ParameterBulkLoader(valueTreeState, ids);
+}
+
+ParameterSnapshot PluginParameters::getSnapshot() const
+{
+    ParameterSnapshot snapshot;
+    for (int i = 0; i < kNumParameters; i++)
+        snapshot.values[i] = workingValues[i].load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void PluginParameters::setWorkingValues(const float* normalisedValues)
+{
+    for (int i = 0; i < kNumParameters; i++)
     {
-        delete pNoteNumberAttachment;
-        pNoteNumberAttachment = nullptr;
+        // convert as the parameter object would: linear range, snapped to the interval
+        const ParameterSpec& spec = specs[i];
+        float value = spec.minValue + jlimit(0.0f, 1.0f, normalisedValues[i]) * (spec.maxValue - spec.minValue);
+        if (spec.interval > 0.0f)
+            value = spec.minValue + spec.interval * std::round((value - spec.minValue) / spec.interval);
+        workingValues[i].store(toWorkingValue(spec, value), std::memory_order_relaxed);
     }
-    if (pLevelAttachment != nullptr)
+}
+
+void PluginParameters::putToXml(XmlElement& xml)
+{
+    // Set XML attributes based on parameter values; choices are stored by name
+    for (int i = 0; i < kNumParameters; i++)
     {
-        delete pLevelAttachment;
-        pLevelAttachment = nullptr;
+        const ParameterSpec& spec = specs[i];
+        float value = *rawValues[i];
+        if (spec.type == kChoiceParameter)
+            xml.setAttribute(spec.id, getText(i, value));
+        else
+            xml.setAttribute(spec.id, value);
     }
-    if (pLoudAttachment != nullptr)
+}
+
+void PluginParameters::getFromXml(XmlElement* pXml)
+{
+    // Set parameters based on XML attributes, all at once
+    // Parameter listeners will propagate to working values
+    NamedValueSet values;
+    for (int i = 0; i < kNumParameters; i++)
     {
-        delete pLoudAttachment;
-        pLoudAttachment = nullptr;
+        const ParameterSpec& spec = specs[i];
+        if (!pXml->hasAttribute(spec.id)) continue;
+
+        float value = (spec.type == kChoiceParameter)
+            ? getValueForText(i, pXml->getStringAttribute(spec.id))
+            : (float)pXml->getDoubleAttribute(spec.id);
+        values.set(spec.id, value);
     }
+    applyValues(values);
 }
 
-void PluginParameters::attachControls(  ComboBox& waveformCombo,
-                                        Slider& noteNumberSlider,
-                                        Slider& levelSlider,
-                                        ToggleButton& loudToggle)
+// Binary state format
+static const int binaryStateMagic = 0x42565041;     // "APVB", little-endian
+static const int binaryStateVersion = 2;
+static const int binaryStateHeaderSize = 8;
+
+// 32-bit FNV-1a
+static uint32 addToHash(uint32 h, const char* text)
 {
-    detachControls();   // destroy existing attachments, if any
+    for (const char* p = text; *p != 0; p++) h = (h ^ (uint8)*p) * 16777619u;
+    return h;
+}
 
-    pWaveformAttachment = new ComboBoxAttachment(valueTreeState, waveform_Id, waveformCombo);
-    pNoteNumberAttachment = new SliderAttachment(valueTreeState, midiNoteNumber_Id, noteNumberSlider);
-    pLevelAttachment = new SliderAttachment(valueTreeState, level_Id, levelSlider);
-    pLoudAttachment = new ButtonAttachment(valueTreeState, loud_Id, loudToggle);
+static uint32 getIdHash(const char* parameterId)
+{
+    return addToHash(2166136261u, parameterId);
 }
 
-void PluginParameters::putToXml(XmlElement& xml)
+int PluginParameters::indexOfIdHash(uint32 idHash)
 {
-    // Set XML attributes based on working parameter values
-    xml.setAttribute(waveform_Name, waveform.name());
-    xml.setAttribute(midiNoteNumber_Name, midiNoteNumber);
-    xml.setAttribute(level_Name, level);
-    xml.setAttribute(loud_Name, loud);
+    // id hash -> ParameterIndex, built once
+    struct IdHashIndex
+    {
+        HashMap<int, int> indexByHash;
+        IdHashIndex()
+        {
+            for (int i = 0; i < kNumParameters; i++)
+                indexByHash.set((int)getIdHash(specs[i].id), i);
+        }
+    };
+    static const IdHashIndex index;
+    return index.indexByHash.contains((int)idHash) ? index.indexByHash[(int)idHash] : -1;
 }
 
-void PluginParameters::getFromXml(XmlElement* pXml)
+uint32 PluginParameters::getSchemaHash(int numSpecs)
 {
-    // Set parameters based on XML attributes
-    // Parameter listeners will propagate to working values
+    // FNV-1a over each parameter's id and type, for the first numSpecs entries in the table
+    uint32 h = 2166136261u;
+    for (int i = 0; i < jmin(numSpecs, (int)kNumParameters); i++)
+    {
+        h = addToHash(h, specs[i].id);
+        h = (h ^ 0u) * 16777619u;
+        h = (h ^ (uint8)specs[i].type) * 16777619u;
+    }
+    return h;
+}
 
-    SynthWaveform wf;
-    wf.setFromName(pXml->getStringAttribute(waveform_Name));
-    valueTreeState.getParameterAsValue(waveform_Id).setValue(wf.getIndex());
+uint32 PluginParameters::getSchemaHash()
+{
+    static const uint32 hash = getSchemaHash(kNumParameters);
+    return hash;
+}
 
-    int nn = pXml->getIntAttribute(midiNoteNumber_Name);
-    valueTreeState.getParameterAsValue(midiNoteNumber_Id).setValue(nn);
+void PluginParameters::putToBinary(MemoryBlock& destData)
+{
+    // Version 2: (id hash, value) pairs, so state can be restored by id whatever parameters
+    // are added, removed or reordered later. Values are stored un-normalised, so they keep
+    // their meaning if a parameter's range changes.
+    destData.setSize(0);
+    MemoryOutputStream out(destData, false);
+    out.writeInt(binaryStateMagic);
+    out.writeShort((short)binaryStateVersion);
+    out.writeShort((short)kNumParameters);
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        out.writeInt((int)getIdHash(specs[i].id));
+        out.writeFloat(*rawValues[i]);
+    }
+}
 
-    float lvl = (float)pXml->getDoubleAttribute(level_Name);
-    valueTreeState.getParameterAsValue(level_Id).setValue(lvl);
+bool PluginParameters::getFromBinary(const void* data, int sizeInBytes)
+{
+    if (sizeInBytes < binaryStateHeaderSize) return false;
+
+    MemoryInputStream in(data, (size_t)sizeInBytes, false);
+    if (in.readInt() != binaryStateMagic) return false;
+    const int version = in.readShort();
+    const int numValues = in.readShort();
+
+    // parameters not in the saved state get their defaults
+    float values[kNumParameters];
+    for (int i = 0; i < kNumParameters; i++)
+        values[i] = specs[i].defaultValue;
+
+    if (version == 1)
+    {
+        // Version 1: a hash of the parameter table, then normalised values in table order.
+        // Parameters have only ever been appended to the table, so the values belong to the
+        // first numValues entries, if the hash of those entries matches.
+        const uint32 schemaHash = (uint32)in.readInt();
+        if (numValues < 0 || numValues > kNumParameters || schemaHash != getSchemaHash(numValues)
+            || in.getNumBytesRemaining() < numValues * (int)sizeof(float))
+            return false;
+
+        for (int i = 0; i < numValues; i++)
+        {
+            const ParameterSpec& spec = specs[i];
+            values[i] = spec.minValue + jlimit(0.0f, 1.0f, in.readFloat()) * (spec.maxValue - spec.minValue);
+        }
+    }
+    else if (version == binaryStateVersion)
+    {
+        if (numValues < 0 || in.getNumBytesRemaining() < numValues * 2 * (int)sizeof(int)) return false;
+
+        // values for ids this build does not know are ignored
+        for (int n = 0; n < numValues; n++)
+        {
+            const uint32 idHash = (uint32)in.readInt();
+            const float value = in.readFloat();
+            const int i = indexOfIdHash(idHash);
+            if (i >= 0) values[i] = value;
+        }
+    }
+    else return false;      // a newer format
 
-    int isLoud = pXml->getBoolAttribute(loud_Name) ? 1 : 0;
-    valueTreeState.getParameterAsValue(loud_Id).setValue(isLoud);
+    bulkLoader->applyValues(values, kNumParameters);
+    return true;
 }
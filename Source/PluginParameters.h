@@ -20,98 +20,170 @@ THE SOFTWARE.
 */
 #pragma once
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
 #include "SynthWaveform.h"
+#include "ParameterBulkLoader.h"
+#include <atomic>
 
-typedef AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
-typedef AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
-typedef AudioProcessorValueTreeState::ButtonAttachment ButtonAttachment;
+// Compile-time index of every parameter. Hot-path code reads values by index, never by id.
+enum ParameterIndex
+{
+    kWaveform,
+    kMidiNoteNumber,
+    kLevel,
+    kLoud,
+    kOversampling,
+
+    kNumParameters
+};
+
+// Parameter types determine working-value conversion and which GUI control edits them
+enum ParameterType
+{
+    kChoiceParameter,       // edited with a ComboBox; working value is the 0-based choice index
+    kIntegerParameter,      // edited with a Slider; working value is rounded to an integer
+    kFloatParameter,        // edited with a Slider; working value is scaled by workingScale
+    kBoolParameter          // edited with a ToggleButton; working value is 0 or 1
+};
+
+// One entry in the parameter table. Everything about a parameter is described here:
+// creation, listeners, GUI attachments and serialization are all generated from the table.
+struct ParameterSpec
+{
+    const char* id;         // symbolic name, used to tag AudioParameter objects and XML attributes
+    const char* name;       // human-friendly name for GUIs
+    const char* label;      // supplementary, typically used for units of measure
+    ParameterType type;
+    float minValue, maxValue, interval;
+    float defaultValue;
+    float workingScale;     // multiply parameter values by this to get working value
+    String (*valueToText)(float value);
+    float (*textToValue)(const String& text);
+};
+
+// Packed copy of all working parameter values, taken by the audio thread once per block
+struct alignas(64) ParameterSnapshot
+{
+    float values[kNumParameters];   // working values, by ParameterIndex
+
+    float getFloat(ParameterIndex i) const { return values[i]; }
+    int getInt(ParameterIndex i) const { return (int)values[i]; }
+    bool getBool(ParameterIndex i) const { return values[i] != 0.0f; }
+    SynthWaveform getWaveform(ParameterIndex i) const { SynthWaveform wf; wf.setIndex(getInt(i)); return wf; }
+};
 
 struct PluginParameters
 {
-    // Id's are symbolic names, Names are human-friendly names for GUI
-    // Labels are supplementary, typically used for units of measure
-    static const String waveform_Id, waveform_Name, waveform_Label;
-    static const String midiNoteNumber_Id, midiNoteNumber_Name, midiNoteNumber_Label;
-    static const String level_Id, level_Name, level_Label;
-    static const String loud_Id, loud_Name, loud_Label;
+    // Text conversion functions used in the parameter table
+    static String noteNumberToText(float value);
+    static String numberToText(float value);
+    static float numberFromText(const String& text);
+    static String boolToText(float value);
+    static float boolFromText(const String& text);
+    static String oversamplingToText(float value);
+    static float oversamplingFromText(const String& text);
+
+    // Text of any parameter's value, and back. Stepped parameters use their shared
+    // ParameterTextTable; text not found there is parsed by the table's textToValue.
+    static String getText(int parameterIndex, float value);
+    static float getValueForText(int parameterIndex, const String& text);
+
+    // The parameter table, indexed by ParameterIndex. To add a parameter, add an index above
+    // and an entry here; nothing else needs to change.
+    static constexpr ParameterSpec specs[kNumParameters] =
+    {
+        // waveform: choice out of 4 possibilities, values 0..3
+        { "waveform", "Waveform", "", kChoiceParameter,
+          0.0f, (float)(SynthWaveform::kChoices - 1), 1.0f, 0.0f, 1.0f,
+          SynthWaveform::floatToText, SynthWaveform::textToFloat },
+
+        // note number: integer parameter, range 0..127
+        { "midiNoteNumber", "Midi Note Number", "", kIntegerParameter,
+          0.0f, 127.0f, 1.0f, 60.0f, 1.0f,
+          noteNumberToText, numberFromText },
+
+        // level: float parameter, range 0.0-1.0, shown as 0.0-10.0 (scaled x10)
+        { "level", "Level", "/10", kFloatParameter,
+          0.0f, 10.0f, 0.0f, 5.0f, 0.1f,
+          numberToText, numberFromText },
+
+        // loud: boolean parameter, range 0.0-1.0, show as "yes" or "no"
+        { "loud", "Loud", "", kBoolParameter,
+          0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+          boolToText, boolFromText },
+
+        // oversampling: choice of 1x, 2x, 4x or 8x, stored as log2 of the factor, values 0..3
+        { "oversampling", "Oversampling", "", kChoiceParameter,
+          0.0f, 3.0f, 1.0f, 0.0f, 1.0f,
+          oversamplingToText, oversamplingFromText },
+    };
 
     PluginParameters(AudioProcessorValueTreeState& vts);
     void createAllParameters();
-    void detachControls();
-    void attachControls(ComboBox& waveformCombo,
-                        Slider& noteNumberSlider,
-                        Slider& levelSlider,
-                        ToggleButton& loudToggle);
-
-    // Actual working parameter values
-    SynthWaveform waveform;
-    int midiNoteNumber;
-    float level;
-    bool loud;
-    
+
+    // Read all working values at once (lock-free; call once per block on the audio thread)
+    ParameterSnapshot getSnapshot() const;
+
+    // Replace all working values at once from normalised (0..1) values in table order, e.g. a
+    // preset. Lock-free, so the audio thread can switch presets between blocks; the parameter
+    // objects themselves are not changed, so the host and GUI must be updated separately.
+    void setWorkingValues(const float* normalisedValues);
+
     // get/put XML
     void putToXml(XmlElement& xml);
     void getFromXml(XmlElement* xml);
 
+    // get/put compact binary state: a small header (magic number, format version, number of
+    // values), then a hash of each parameter's id with its value. State is restored by id, so
+    // it survives parameters being added, removed or reordered; parameters missing from the
+    // state get their defaults. getFromBinary() returns false if the data is not in this
+    // format (or a version it can migrate from).
+    void putToBinary(MemoryBlock& destData);
+    bool getFromBinary(const void* data, int sizeInBytes);
+
+    // Hash of the parameter ids and types in the table, in order (of the first numSpecs only)
+    static uint32 getSchemaHash();
+    static uint32 getSchemaHash(int numSpecs);
+
+    // Apply many (id, value) pairs at once, with one change notification at the end.
+    // ChangeListeners registered with getBulkLoader() receive that notification.
+    void applyValues(const NamedValueSet& values) { bulkLoader->applyValues(values); }
+    ParameterBulkLoader& getBulkLoader() { return *bulkLoader; }
+
+
 private:
     // Reference to AudioProcessorValueTreeState object that owns the parameter objects
     AudioProcessorValueTreeState& valueTreeState;
 
-    // Attachment objects link GUI controls to parameters
-    ComboBoxAttachment* pWaveformAttachment;
-    SliderAttachment* pNoteNumberAttachment;
-    SliderAttachment* pLevelAttachment;
-    ButtonAttachment* pLoudAttachment;
+    // Actual working parameter values, by ParameterIndex. These are written by parameter
+    // listeners on whatever thread changes the parameter, and read by the audio thread,
+    // so they are atomic.
+    std::atomic<float> workingValues[kNumParameters];
 
-    // Specialized versions of AudioProcessorValueTreeState::Listener adapted for our parameter types
-    struct WaveformListener : public AudioProcessorValueTreeState::Listener
-    {
-        SynthWaveform& waveform;
+    // Created by createAllParameters(), once the parameter objects exist
+    ScopedPointer<ParameterBulkLoader> bulkLoader;
 
-        WaveformListener(SynthWaveform& wf) : AudioProcessorValueTreeState::Listener(), waveform(wf) {}
-        void parameterChanged(const String&, float newValue) override
-        {
-            waveform.setIndex((int)(newValue + 0.5f));
-        }
-    };
+    // Parameter values owned by the AudioProcessorValueTreeState, by ParameterIndex, looked up
+    // once by createAllParameters() so saving state needs no id lookups
+    float* rawValues[kNumParameters];
 
-    struct IntegerListener : public AudioProcessorValueTreeState::Listener
+    // AudioProcessorValueTreeState::Listener which converts one parameter's value to its working value
+    struct WorkingValueListener : public AudioProcessorValueTreeState::Listener
     {
-        int& workingValue;
+        std::atomic<float>* workingValue;
+        const ParameterSpec* spec;
 
-        IntegerListener(int& wv) : AudioProcessorValueTreeState::Listener(), workingValue(wv) {}
+        WorkingValueListener() : workingValue(nullptr), spec(nullptr) {}
         void parameterChanged(const String&, float newValue) override
         {
-            workingValue = (int)newValue;
+            *workingValue = toWorkingValue(*spec, newValue);
         }
     };
 
-    struct FloatListener : public AudioProcessorValueTreeState::Listener
-    {
-        float& workingValue;
-        float scaleFactor;      // multiply parameter values by this to get working value
+    static float toWorkingValue(const ParameterSpec& spec, float parameterValue);
 
-        FloatListener(float& wv, float sf=1.0f) : AudioProcessorValueTreeState::Listener(), workingValue(wv), scaleFactor(sf) {}
-        void parameterChanged(const String&, float newValue) override
-        {
-            workingValue = scaleFactor * newValue;
-        }
-    };
-
-    struct BoolListener : public AudioProcessorValueTreeState::Listener
-    {
-        bool& workingValue;
-
-        BoolListener(bool& wv) : AudioProcessorValueTreeState::Listener(), workingValue(wv) {}
-        void parameterChanged(const String&, float newValue) override
-        {
-            workingValue = newValue >= 0.5f;
-        }
-    };
+    // ParameterIndex of the parameter whose id has the given hash, or -1
+    static int indexOfIdHash(uint32 idHash);
 
-    WaveformListener waveformListener;
-    IntegerListener noteNumberListener;
-    FloatListener levelListener;
-    BoolListener loudListener;
+    WorkingValueListener listeners[kNumParameters];
 };
@@ -31,82 +31,530 @@ AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 PluginProcessor::PluginProcessor()
     : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo(), true)
                                        .withOutput ("Output", AudioChannelSet::stereo(), true) )
-    , valueTreeState(*this, &undoManager)
+    , valueTreeState(*this, nullptr)   // undo is recorded per gesture by undoTracker
+    , undoManager(kDefaultUndoHistoryUnits, kDefaultMinUndoTransactions)
+    , undoTracker(*this, undoManager)
     , parameters(valueTreeState)
+    , smoothingTimeSeconds(0.02)
+    , expectedTransportPosition(-1)
+    , tailSamplesRemaining(0)
+    , defaultBankChecked(false)
+    , currentProgram(0)
+    , appliedProgram(0)
+    , programNeedsHostUpdate(false)
+    , prepared(false)
+    , programChangeFifo(kProgramChangeFifoSize)
+    , numMidiPrograms(0)
+    , crossfading(false)
+    , latencyChanged(false)
+    , undoHistoryNeedsClearing(false)
+    , numVoiceWorkers(jlimit(0, (int)kMaxDefaultVoiceWorkers, SystemStats::getNumCpus() - 1))
+    , voiceThreadingThreshold(kDefaultVoiceThreadingThreshold)
 {
+    for (auto& gain : channelGains) gain = 1.0f;
+
     // call state.createAndAddParameter() for all params...
     parameters.createAllParameters();
 
+    voices.setMaxVoices(kDefaultMaxVoices);
+
+    crossfadeBuffer.allocate(kCrossfadeChunkSamples, true);
+    crossfadeBufferDouble.allocate(kCrossfadeChunkSamples, true);
+    programChanges.allocate(kProgramChangeFifoSize, true);
+
     // initialize the ValueTree object within our AudioProcessorValueTreeState
     valueTreeState.state = ValueTree(Identifier(JucePlugin_Name));
+
+    startTimer(kHostUpdateIntervalMs);
 }
 
 void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    ignoreUnused(samplesPerBlock);
+    ParameterSnapshot params = parameters.getSnapshot();
+    float level = params.getFloat(kLevel);
+    if (params.getBool(kLoud)) level *= 2.0f;
+
+    // allocate voice, event and oversampling storage here, so the audio thread never has to
+    // (both precisions are prepared, as the host may switch between them)
+    oversampler.prepare(samplesPerBlock);
+    oversampler.setFactorLog2(params.getInt(kOversampling));
+    oversamplerDouble.prepare(samplesPerBlock);
+    oversamplerDouble.setFactorLog2(params.getInt(kOversampling));
+    const double renderRate = sampleRate * oversampler.getFactor();
+    voices.prepare(renderRate);
+    voiceWorkers.start(voices.getMaxVoices() >= voiceThreadingThreshold ? numVoiceWorkers : 0);
+    voiceWorkers.setSpinTime(jmax((int)SynthWorkerPool::kDefaultSpinMicroseconds,
+                                  roundToInt(2.0e6 * samplesPerBlock / sampleRate)));  // two block periods
+    voices.setWorkerPool(&voiceWorkers, voiceThreadingThreshold);
+    events.prepare(kMaxEventsPerBlock);
+    loadMeter.prepare(sampleRate);
+    scopeBuffer.prepare();
 
-    oscillator.setWaveform(parameters.waveform);
-    oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(parameters.midiNoteNumber) / sampleRate);
+    const int smoothingSamples = roundToInt(smoothingTimeSeconds * renderRate);
+    oscillator.setSmoothingSamples(smoothingSamples);
+    oscillator.setWaveform(params.getWaveform(kWaveform));
+    oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(params.getInt(kMidiNoteNumber)) / renderRate);
+    oscillator.resetSmoothing(level);
+    voices.setSmoothingSamples(smoothingSamples);
+    crossfading = false;
+    tailSamplesRemaining = 0;
+    prepared = true;
+
+    setLatencySamples(roundToInt(SynthOversampler<float>::getLatencySamples(oversampler.getFactorLog2())));
 }
 
 void PluginProcessor::releaseResources()
 {
+    prepared = false;
+    voices.setWorkerPool(nullptr, voiceThreadingThreshold);
+    voiceWorkers.stop();
 }
 
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
+    // Any output layout is supported (mono, stereo, surround, ambisonic...), since the
+    // signal is rendered once and fanned out to every channel
+    const int numOutputs = layouts.getMainOutputChannelSet().size();
+    if (numOutputs < 1 || numOutputs > kMaxOutputChannels)
         return false;
 
-    // This checks if the input layout matches the output layout
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    // This checks if the input layout matches the output layout (or the input is disabled)
+    if (!layouts.getMainInputChannelSet().isDisabled()
+     && layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
 
     return true;
 }
 
-void PluginProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+void PluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    processSamples(buffer, midiMessages);
+}
+
+void PluginProcessor::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
 {
-    ignoreUnused(midiMessages);
+    processSamples(buffer, midiMessages);
+}
+
+// Both precisions are rendered by the same code, with sample-type-templated kernels all the
+// way down, so a double-precision host gets double output with no conversion pass
+template <typename SampleType>
+void PluginProcessor::processSamples (AudioBuffer<SampleType>& buffer, MidiBuffer& midiMessages)
+{
+    // in audit builds, flags any allocation, lock or blocking system call made from here on
+    RealtimeSafetyAudit::ScopedSection realtimeAudit;
+
+    // offline renders have no real-time deadline, so are not measured
+    DspLoadMeter::ScopedTimer loadTimer(loadMeter, isNonRealtime() ? 0 : buffer.getNumSamples());
+
+    const int numSamples = buffer.getNumSamples();
+    events.clear();
+    events.addMidiEvents(midiMessages, numSamples);
+
+    // Program changes take effect at the start of the block they arrive in (the last one
+    // wins), by swapping in the preset's values before parameters are read
+    int midiProgram = -1;
+    for (int i = 0; i < events.size(); i++)
+        if (events[i].type == SynthEvent::kProgramChange)
+            midiProgram = events[i].noteNumber;
+    const bool programChanged = switchProgram(midiProgram);
+
+    // Read all parameters once, lock-free, at the top of the block
+    const ParameterSnapshot params = parameters.getSnapshot();
+    const int oversamplingBefore = oversampler.getFactorLog2();
+    const float level = applyParameters(params);
+    syncToTransport(numSamples);
+
+    if (programChanged)
+    {
+        // The new program fades in from silence at its own pitch, as the old one fades out.
+        // A change of oversampling resets the oscillator anyway, so then there is no crossfade.
+        oscillator.resetSmoothing(0.0f);
+        crossfading = oversampler.getFactorLog2() == oversamplingBefore && !fadingOscillator.isSilent();
+    }
 
-    oscillator.setWaveform(parameters.waveform);
-    oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(parameters.midiNoteNumber) / getSampleRate());
+    // Split the block at MIDI event timestamps, rendering the runs between events, so that
+    // every event takes effect at exactly the sample where it occurs.
+    // (Parameters are snapshotted above: JUCE's plugin wrappers deliver them between
+    // blocks, so there are no intra-block parameter change points to split at.)
 
-    float level = parameters.level;
-    if (parameters.loud) level *= 2.0f;
-    
-    if (buffer.getNumChannels() == 1)
+    // Silent path: with the level at zero, every gain ramp finished and the oversampling
+    // filters flushed of the last sound (so none of its tail is cut off), there is nothing to
+    // render. Clear the buffer, and just advance the oscillator and voice phases in O(1), so
+    // sound resumes without a discontinuity.
+    const bool synthSilent = level == 0.0f && oscillator.isSilent() && voices.isSilent() && !crossfading;
+    if (synthSilent && tailSamplesRemaining <= 0)
     {
-        float* pLeft = buffer.getWritePointer(0);
-        for (int i = 0; i < buffer.getNumSamples(); i++)
+        buffer.clear();
+
+        int startSample = 0;
+        for (int i = 0; i < events.size(); i++)
         {
-            *pLeft++ = oscillator.getSample() * level;
+            const SynthEvent& event = events[i];
+            skipRun(event.sampleOffset - startSample, level);
+            startSample = jmax(startSample, event.sampleOffset);
+            handleEvent(event, params);
         }
+        skipRun(numSamples - startSample, level);
+        scopeBuffer.pushSilence(numSamples);
+        return;
     }
-    else
+
+    SampleType* pLeft = buffer.getWritePointer(0);
+
+    int startSample = 0;
+    for (int i = 0; i < events.size(); i++)
     {
-        float* pLeft = buffer.getWritePointer(0);
-        float* pRight = buffer.getWritePointer(1);
-        for (int i = 0; i < buffer.getNumSamples(); i++)
+        const SynthEvent& event = events[i];
+        if (event.sampleOffset > startSample)
         {
-            *pLeft++ = *pRight++ = oscillator.getSample() * level;
+            renderRun(pLeft + startSample, event.sampleOffset - startSample, level);
+            startSample = event.sampleOffset;
         }
+        handleEvent(event, params);
+    }
+    renderRun(pLeft + startSample, numSamples - startSample, level);
+    scopeBuffer.pushBlock(pLeft, numSamples);
+
+    // once the synth is silent, the filters need the length of their tail to flush
+    if (synthSilent) tailSamplesRemaining -= numSamples;
+    else tailSamplesRemaining = SynthOversampler<float>::getTailSamples(oversampler.getFactorLog2());
+
+    // Fan the rendered signal out to every output channel: one vectorized copy per channel,
+    // with that channel's gain. Channel 0 holds the source, so it is scaled last, in place.
+    const int numChannels = jmin(buffer.getNumChannels(), (int)kMaxOutputChannels);
+    for (int c = numChannels - 1; c > 0; c--)
+    {
+        const SampleType gain = channelGains[c].load(std::memory_order_relaxed);
+        SampleType* dest = buffer.getWritePointer(c);
+        if (gain == 1) FloatVectorOperations::copy(dest, pLeft, numSamples);
+        else if (gain == 0) FloatVectorOperations::clear(dest, numSamples);
+        else FloatVectorOperations::copyWithMultiply(dest, pLeft, gain, numSamples);
+    }
+    const SampleType gain0 = channelGains[0].load(std::memory_order_relaxed);
+    if (gain0 != 1) FloatVectorOperations::multiply(pLeft, gain0, numSamples);
+
+    // clear any channels beyond kMaxOutputChannels
+    for (int c = numChannels; c < buffer.getNumChannels(); c++)
+        buffer.clear(c, 0, numSamples);
+}
+
+void PluginProcessor::skipSamples(int numSamples)
+{
+    const ParameterSnapshot params = parameters.getSnapshot();
+    skipRun(numSamples, applyParameters(params));
+}
+
+float PluginProcessor::applyParameters(const ParameterSnapshot& params)
+{
+    float level = params.getFloat(kLevel);
+    if (params.getBool(kLoud)) level *= 2.0f;
+
+    if (params.getInt(kOversampling) != oversampler.getFactorLog2())
+        setOversampling(params.getInt(kOversampling), level);
+
+    const double renderRate = getSampleRate() * oversampler.getFactor();
+    oscillator.setWaveform(params.getWaveform(kWaveform));
+    oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(params.getInt(kMidiNoteNumber)) / renderRate);
+    voices.setWaveform(params.getWaveform(kWaveform));
+
+    return level;
+}
+
+template <typename SampleType>
+void PluginProcessor::renderRun(SampleType* dest, int numSamples, float level)
+{
+    if (numSamples <= 0) return;
+
+    auto& os = getOversampler(dest);
+    const int factor = os.getFactor();
+    if (factor == 1)
+    {
+        renderSynth(dest, numSamples, level);
+        return;
+    }
+
+    // Render at the oversampled rate, then decimate into dest, in chunks which fit the
+    // oversampler's buffer (hosts may exceed the block size given to prepareToPlay)
+    while (numSamples > 0)
+    {
+        const int n = jmin(numSamples, os.getMaxBlockSize());
+        SampleType* oversampled = os.getBuffer();
+        renderSynth(oversampled, n * factor, level);
+        os.decimate(dest, n);
+
+        dest += n;
+        numSamples -= n;
+    }
+}
+
+// Render everything at the render rate into dest, overwriting it
+template <typename SampleType>
+void PluginProcessor::renderSynth(SampleType* dest, int numSamples, float level)
+{
+    oscillator.renderBlock(dest, numSamples, level);
+
+    // the previous program, if still fading out: its gain ramps to zero over the smoothing time
+    SampleType* scratch = getCrossfadeBuffer(dest);
+    for (int done = 0; crossfading && done < numSamples; done += kCrossfadeChunkSamples)
+    {
+        const int n = jmin(numSamples - done, (int)kCrossfadeChunkSamples);
+        fadingOscillator.renderBlock(scratch, n, 0.0f);
+        FloatVectorOperations::add(dest + done, scratch, n);
+        crossfading = !fadingOscillator.isSilent();
+    }
+
+    voices.addBlock(dest, numSamples, level);
+}
+
+void PluginProcessor::skipRun(int numSamples, float level)
+{
+    if (numSamples <= 0) return;
+
+    const int n = numSamples * oversampler.getFactor();
+    oscillator.skipBlock(n, level);
+    voices.skipBlock(n, level);
+
+    if (crossfading)
+    {
+        fadingOscillator.skipBlock(n, 0.0f);
+        crossfading = !fadingOscillator.isSilent();
+    }
+}
+
+void PluginProcessor::syncToTransport(int numSamples)
+{
+    // While the host is playing, lock the oscillator's phase to the timeline: at the start of
+    // playback, or whenever the position is not where the last block left off (a jump or a
+    // loop restart), seek the oscillator to exactly where it belongs
+    AudioPlayHead::CurrentPositionInfo info;
+    AudioPlayHead* playHead = getPlayHead();
+    if (playHead == nullptr || !playHead->getCurrentPosition(info) || !info.isPlaying)
+    {
+        expectedTransportPosition = -1;
+        return;
+    }
+
+    if (info.timeInSamples != expectedTransportPosition)
+        oscillator.seekToSample(info.timeInSamples * oversampler.getFactor());
+    expectedTransportPosition = info.timeInSamples + numSamples;
+}
+
+void PluginProcessor::setOversampling(int factorLog2, float level)
+{
+    // Everything here is allocation-free, so it can run on the audio thread
+    oversampler.setFactorLog2(factorLog2);
+    oversamplerDouble.setFactorLog2(factorLog2);
+    const double renderRate = getSampleRate() * oversampler.getFactor();
+    const int smoothingSamples = roundToInt(smoothingTimeSeconds * renderRate);
+    voices.setSampleRate(renderRate);
+    voices.setSmoothingSamples(smoothingSamples);
+    oscillator.setSmoothingSamples(smoothingSamples);
+    oscillator.setFrequency(MidiMessage::getMidiNoteInHertz(parameters.getSnapshot().getInt(kMidiNoteNumber)) / renderRate);
+    oscillator.resetSmoothing(level);
+
+    // the host must be told about the new latency on the message thread (see timerCallback)
+    latencyChanged = true;
+}
+
+// Bring the parameter objects, and so the host and GUI, into line with a program switched by
+// the audio thread (this rewrites the same working values). The program applied is the one the
+// audio thread switched to, not one still queued, which must wait for its crossfade.
+void PluginProcessor::flushAppliedProgram()
+{
+    if (programNeedsHostUpdate.exchange(false))
+    {
+        float values[kNumParameters];
+        if (presetBank.getValues(appliedProgram, values))
+            parameters.getBulkLoader().applyNormalisedValues(values, kNumParameters);
+        updateHostDisplay();
+    }
+}
+
+void PluginProcessor::timerCallback()
+{
+    flushAppliedProgram();
+
+    if (undoHistoryNeedsClearing.exchange(false))
+        undoManager.clearUndoHistory();
+
+    if (latencyChanged.exchange(false))
+    {
+        const int factorLog2 = parameters.getSnapshot().getInt(kOversampling);
+        setLatencySamples(roundToInt(SynthOversampler<float>::getLatencySamples(factorLog2)));
+    }
+}
+
+// Apply the latest program change requested, if any: the host's (queued), then a MIDI
+// program change in this block
+bool PluginProcessor::switchProgram(int midiProgram)
+{
+    float values[kNumParameters];
+    int program = -1;
+
+    const int numReady = programChangeFifo.getNumReady();
+    if (numReady > 0)
+    {
+        int start1, size1, start2, size2;
+        programChangeFifo.prepareToRead(numReady, start1, size1, start2, size2);
+        const ProgramChange& latest = programChanges[size2 > 0 ? start2 + size2 - 1 : start1 + size1 - 1];
+        program = latest.program;
+        memcpy(values, latest.values, sizeof(values));
+        programChangeFifo.finishedRead(numReady);
+    }
+
+    if (isPositiveAndBelow(midiProgram, numMidiPrograms))
+    {
+        program = midiProgram;
+        memcpy(values, midiProgramValues + midiProgram * kNumParameters, sizeof(values));
+    }
+
+    if (program < 0) return false;
+
+    // keep the outgoing sound, then swap the preset's values in, lock-free
+    fadingOscillator = oscillator;
+    parameters.setWorkingValues(values);
+    appliedProgram = program;
+    currentProgram = program;
+
+    // the parameter objects, host and GUI catch up in timerCallback()
+    programNeedsHostUpdate = true;
+    return true;
+}
+
+void PluginProcessor::openDefaultBankIfNeeded()
+{
+    if (defaultBankChecked) return;
+    defaultBankChecked = true;
+
+    const File bankFile = getDefaultPresetBankFile();
+    if (bankFile.existsAsFile()) loadPresetBank(bankFile);
+}
+
+int PluginProcessor::getNumPrograms()
+{
+    openDefaultBankIfNeeded();
+    return jmax(1, presetBank.getNumPresets());
+}
+
+const String PluginProcessor::getProgramName(int index)
+{
+    openDefaultBankIfNeeded();
+    return presetBank.getName(index);
+}
+
+void PluginProcessor::setCurrentProgram(int index)
+{
+    openDefaultBankIfNeeded();
+
+    ProgramChange change;
+    if (!presetBank.getValues(index, change.values)) return;
+    change.program = index;
+
+    // While audio is running, the audio thread switches at its next block, with a crossfade;
+    // otherwise the preset is simply applied to the parameters here. (The host calls this on
+    // one thread at a time, so the queue has a single writer.)
+    if (!prepared)
+    {
+        parameters.getBulkLoader().applyNormalisedValues(change.values, kNumParameters);
+        appliedProgram = index;
+        currentProgram = index;
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    programChangeFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
+    {
+        jassertfalse;   // the audio thread has not taken a program change for a long while: dropped
+        return;
+    }
+    programChanges[start1] = change;
+    programChangeFifo.finishedWrite(1);
+    currentProgram = index;
+}
+
+bool PluginProcessor::loadPresetBank(const File& bankFile)
+{
+    // a pending program update refers to the old bank
+    flushAppliedProgram();
+
+    defaultBankChecked = true;
+    const bool opened = presetBank.open(bankFile);
+
+    // decode the presets MIDI program changes can select, before the audio thread sees them
+    HeapBlock<float> midiValues((size_t)kNumMidiPrograms * kNumParameters);
+    const int numMidi = jmin(presetBank.getNumPresets(), (int)kNumMidiPrograms);
+    for (int p = 0; p < numMidi; p++)
+        presetBank.getValues(p, midiValues + p * kNumParameters);
+
+    // the audio thread reads the MIDI program table, so it must not be processing while the
+    // table is swapped in
+    const bool wasSuspended = isSuspended();
+    suspendProcessing(true);
+    midiProgramValues.swapWith(midiValues);
+    numMidiPrograms = numMidi;
+    programChangeFifo.reset();
+    programNeedsHostUpdate = false;
+    appliedProgram = 0;
+    currentProgram = 0;
+    suspendProcessing(wasSuspended);
+
+    updateHostDisplay();
+    return opened;
+}
+
+File PluginProcessor::getDefaultPresetBankFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+        .getChildFile(JucePlugin_Name).getChildFile("Presets.bank");
+}
+
+void PluginProcessor::handleEvent(const SynthEvent& event, const ParameterSnapshot& params)
+{
+    switch (event.type)
+    {
+    case SynthEvent::kNoteOn:
+        voices.noteOn(event.noteNumber, event.velocity, params.getWaveform(kWaveform));
+        break;
+    case SynthEvent::kNoteOff:
+        voices.noteOff(event.noteNumber);
+        break;
+    case SynthEvent::kAllNotesOff:
+        voices.allNotesOff();
+        break;
+    case SynthEvent::kProgramChange:
+        break;  // already applied at the start of the block
     }
 }
 
 void PluginProcessor::getStateInformation (MemoryBlock& destData)
 {
-    ScopedPointer<XmlElement> pXml(valueTreeState.state.createXml());
-    copyXmlToBinary(*pXml, destData);
+    // a program the audio thread has switched to may not have reached the parameters yet
+    flushAppliedProgram();
+    parameters.putToBinary(destData);
 }
 
 void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    ScopedPointer<XmlElement> pXml = getXmlFromBinary(data, sizeInBytes);
-    if (pXml != nullptr)
-        if (pXml->hasTagName(valueTreeState.state.getType()))
-            valueTreeState.state = ValueTree::fromXml(*pXml);
+    // Current binary format first; fall back to XML, as saved by earlier versions
+    if (!parameters.getFromBinary(data, sizeInBytes))
+    {
+        ScopedPointer<XmlElement> pXml = getXmlFromBinary(data, sizeInBytes);
+        if (pXml != nullptr)
+            if (pXml->hasTagName(valueTreeState.state.getType()))
+            {
+                // Gather all saved parameter values, then apply them in one batch
+                NamedValueSet values;
+                forEachXmlChildElementWithTagName(*pXml, pParam, "PARAM")
+                    values.set(pParam->getStringAttribute("id"), pParam->getDoubleAttribute("value"));
+                parameters.applyValues(values);
+            }
+    }
+
+    // restoring state is not an undoable action
+    if (MessageManager::getInstance()->isThisTheMessageThread())
+        undoManager.clearUndoHistory();
+    else
+        undoHistoryNeedsClearing = true;
 }
@@ -20,12 +20,21 @@ THE SOFTWARE.
 */
 #pragma once
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
 #include "PluginEditor.h"
 #include "PluginParameters.h"
 #include "SynthOscillator.h"
-
-class PluginProcessor : public AudioProcessor
+#include "SynthVoicePool.h"
+#include "SynthWorkerPool.h"
+#include "SynthEventList.h"
+#include "SynthOversampler.h"
+#include "RealtimeSafetyAudit.h"
+#include "DspLoadMeter.h"
+#include "ScopeBuffer.h"
+#include "PresetBank.h"
+#include "UndoTransactionTracker.h"
+
+class PluginProcessor : public AudioProcessor, private Timer
 {
 public:
     PluginProcessor();
@@ -37,7 +46,14 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 #endif
 
-    void processBlock(AudioSampleBuffer&, MidiBuffer&) override;
+    void processBlock(AudioBuffer<float>&, MidiBuffer&) override;
+    void processBlock(AudioBuffer<double>&, MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    // Advance the synth's state by numSamples exactly as processBlock() would, without
+    // rendering anything (no MIDI; parameters are read as for a block). Constant time, so an
+    // offline renderer can start rendering part-way through a timeline.
+    void skipSamples(int numSamples);
 
     AudioProcessorEditor* createEditor() override { return new PluginEditor(*this); }
     bool hasEditor() const override { return true; }
@@ -49,25 +65,161 @@ public:
     bool isMidiEffect() const override { return false; }
     double getTailLengthSeconds() const override { return 0.0; }
 
-    int getNumPrograms() override { return 1; }
-    int getCurrentProgram() override { return 0; }
-    void setCurrentProgram(int) override {}
-    const String getProgramName(int) override { return {}; }
+    // Programs are the presets of the open PresetBank; the default bank is opened the first
+    // time the host asks about programs. A program change from the host (message thread) is
+    // decoded from the bank there, and queued for the audio thread; MIDI program changes select
+    // from the first kNumMidiPrograms presets, decoded when the bank is opened. Either way, the
+    // audio thread switches at the start of a block, with a short crossfade from the outgoing
+    // sound, and never reads the bank file.
+    int getNumPrograms() override;
+    int getCurrentProgram() override { return currentProgram; }
+    void setCurrentProgram(int index) override;
+    const String getProgramName(int index) override;
     void changeProgramName (int, const String&) override {}
 
+    // Open a preset bank file (message thread; briefly suspends processing). Returns false,
+    // leaving no presets, if the file is not a bank for this plugin's parameters.
+    bool loadPresetBank(const File& bankFile);
+    const PresetBank& getPresetBank() const { return presetBank; }
+
+    // Bank opened when the host first asks about programs, if it exists
+    static File getDefaultPresetBankFile();
+
+    static const int kNumMidiPrograms = 128;
+
     void getStateInformation (MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    // Plugin's AudioProcessorValueTreeState, and its associated UndoManager
+    // Plugin's AudioProcessorValueTreeState, and the UndoManager for user edits. The
+    // AudioProcessorValueTreeState has no UndoManager, so host automation is never undoable.
     AudioProcessorValueTreeState valueTreeState;
     UndoManager undoManager;
 
+    // Records user gestures on parameters as undo transactions
+    UndoTransactionTracker undoTracker;
+
+    // Bound the undo history's memory: the oldest transactions are discarded once the history
+    // exceeds maxUnits (roughly bytes), but at least minTransactions are always kept
+    void setUndoHistoryLimit(int maxUnits, int minTransactions) { undoManager.setMaxNumberOfStoredUnits(maxUnits, minTransactions); }
+
+    static const int kDefaultUndoHistoryUnits = 64 * 1024;
+    static const int kDefaultMinUndoTransactions = 30;
+
     // Application's view of the AudioProcessorValueTreeState, including working parameter values
     PluginParameters parameters;
 
-    // Synthesis engine
+    // Synthesis engine: the continuous oscillator, plus a pool of MIDI-driven voices
     SynthOscillator oscillator;
+    SynthVoicePool voices;
+
+    // Per-block processing time as a fraction of the real-time budget, for the editor's load display
+    DspLoadMeter loadMeter;
+
+    // Decimated output for the editor's oscilloscope (captured only while it is showing)
+    ScopeBuffer scopeBuffer;
+
+    // Length of gain ramps and pitch glides; takes effect at the next prepareToPlay()
+    void setSmoothingTime(double seconds) { smoothingTimeSeconds = seconds; }
+
+    // Gain of each output channel (default 1.0); channels are numbered as in the bus layout.
+    // May be called from any thread; takes effect at the next block.
+    void setChannelGain(int channel, float gain) { if (isPositiveAndBelow(channel, (int)kMaxOutputChannels)) channelGains[channel] = gain; }
+    float getChannelGain(int channel) const { return isPositiveAndBelow(channel, (int)kMaxOutputChannels) ? channelGains[channel].load() : 0.0f; }
+
+    // Enough for 7th-order ambisonics
+    static const int kMaxOutputChannels = 64;
+
+    // Render the voices in parallel on numWorkerThreads extra threads whenever at least
+    // minVoices are playing; takes effect at the next prepareToPlay(). No threads are started
+    // unless the polyphony can reach minVoices.
+    void setVoiceThreading(int numWorkerThreads, int minVoices) { numVoiceWorkers = jmax(0, numWorkerThreads); voiceThreadingThreshold = minVoices; }
+
+    static const int kDefaultMaxVoices = 32;
+    static const int kDefaultVoiceThreadingThreshold = 64;
+    static const int kMaxDefaultVoiceWorkers = 3;
+    static const int kMaxEventsPerBlock = 1024;
 
 private:
+    double smoothingTimeSeconds;
+
+    // Host timeline position expected at the next block while playing, or -1
+    int64 expectedTransportPosition;
+
+    // Per-output-channel gains for the render-once fan-out in processBlock
+    std::atomic<float> channelGains[kMaxOutputChannels];
+
+    // This block's events, sorted by time; processBlock renders the runs between them
+    SynthEventList events;
+
+    // Synthesis runs at the host rate times the oversampling factor, then is decimated
+    SynthOversampler<float> oversampler;
+    SynthOversampler<double> oversamplerDouble;
+    SynthOversampler<float>& getOversampler(const float*) { return oversampler; }
+    int tailSamplesRemaining;   // host-rate samples until the filters have flushed after silence
+    SynthOversampler<double>& getOversampler(const double*) { return oversamplerDouble; }
+
+    // Presets (message thread only), and whether the default bank has been looked for
+    PresetBank presetBank;
+    bool defaultBankChecked;
+    void openDefaultBankIfNeeded();
+
+    std::atomic<int> currentProgram;           // last program requested or applied
+    std::atomic<int> appliedProgram;           // last program the audio thread switched to
+    std::atomic<bool> programNeedsHostUpdate;
+    void flushAppliedProgram();
+    std::atomic<bool> prepared;
+
+    // Host program changes, with their decoded values, queued for the audio thread
+    struct ProgramChange
+    {
+        int program;
+        float values[kNumParameters];
+    };
+    AbstractFifo programChangeFifo;
+    HeapBlock<ProgramChange> programChanges;
+    static const int kProgramChangeFifoSize = 16;
+
+    // Values of the presets MIDI program changes can select, decoded when the bank is opened
+    HeapBlock<float> midiProgramValues;
+    int numMidiPrograms;
+
+    // Previous program's sound, fading out while the new program's fades in. It renders into
+    // a scratch buffer, which is added to the output.
+    SynthOscillator fadingOscillator;
+    bool crossfading;
+    HeapBlock<float> crossfadeBuffer;
+    HeapBlock<double> crossfadeBufferDouble;
+    float* getCrossfadeBuffer(const float*) { return crossfadeBuffer; }
+    double* getCrossfadeBuffer(const double*) { return crossfadeBufferDouble; }
+    static const int kCrossfadeChunkSamples = 1024;
+
+    // Set by the audio thread when the oversampling factor (and so the latency) changes; a
+    // message-thread timer polls it and tells the host, so the audio thread never posts messages
+    std::atomic<bool> latencyChanged;
+
+    // Set when state is restored off the message thread; the timer clears the undo history,
+    // since the UndoManager is also used by the editor on the message thread
+    std::atomic<bool> undoHistoryNeedsClearing;
+    static const int kHostUpdateIntervalMs = 50;
+
+    // Helper threads for voice rendering, running between prepareToPlay and releaseResources
+    SynthWorkerPool voiceWorkers;
+    int numVoiceWorkers;
+    int voiceThreadingThreshold;
+
+    template <typename SampleType>
+    void processSamples(AudioBuffer<SampleType>& buffer, MidiBuffer& midiMessages);
+    template <typename SampleType>
+    void renderRun(SampleType* dest, int numSamples, float level);
+    template <typename SampleType>
+    void renderSynth(SampleType* dest, int numSamples, float level);
+    bool switchProgram(int midiProgram);
+    void skipRun(int numSamples, float level);
+    float applyParameters(const ParameterSnapshot& params);
+    void syncToTransport(int numSamples);
+    void setOversampling(int factorLog2, float level);
+    void timerCallback() override;
+    void handleEvent(const SynthEvent& event, const ParameterSnapshot& params);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
 };
@@ -0,0 +1,126 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "PresetBank.h"
+
+// Bank file format
+static const int bankMagic = 0x50565041;    // "APVP", little-endian
+static const int bankVersion = 1;
+static const int bankHeaderSize = 32;
+
+PresetBank::PresetBank()
+    : records(nullptr)
+    , numPresets(0)
+    , recordSize(0)
+{
+}
+
+void PresetBank::close()
+{
+    records = nullptr;
+    numPresets = 0;
+    mappedFile = nullptr;
+}
+
+bool PresetBank::open(const File& bankFile)
+{
+    close();
+
+    ScopedPointer<MemoryMappedFile> file = new MemoryMappedFile(bankFile, MemoryMappedFile::readOnly);
+    const char* data = static_cast<const char*>(file->getData());
+    const size_t size = file->getSize();
+    if (data == nullptr || size < (size_t)bankHeaderSize) return false;
+
+    MemoryInputStream in(data, (size_t)bankHeaderSize, false);
+    if (in.readInt() != bankMagic || in.readShort() != bankVersion) return false;
+
+    const int numValues = in.readShort();
+    const uint32 schemaHash = (uint32)in.readInt();
+    const int count = in.readInt();
+    const int recordBytes = in.readInt();
+    if (numValues != kNumParameters || schemaHash != PluginParameters::getSchemaHash()
+        || recordBytes != getRecordSize() || count < 0
+        || size < (size_t)bankHeaderSize + (size_t)count * (size_t)recordBytes)
+        return false;
+
+    mappedFile = file.release();
+    records = data + bankHeaderSize;
+    numPresets = count;
+    recordSize = recordBytes;
+    return true;
+}
+
+String PresetBank::getName(int index) const
+{
+    if (!isPositiveAndBelow(index, numPresets)) return {};
+
+    const char* name = records + (size_t)index * (size_t)recordSize;
+    int length = 0;
+    while (length < kNameBytes && name[length] != 0) length++;
+    return String::fromUTF8(name, length);
+}
+
+bool PresetBank::getValues(int index, float* values) const
+{
+    if (!isPositiveAndBelow(index, numPresets)) return false;
+
+    // decoded explicitly, as the file is little-endian and records need not be aligned
+    const char* data = records + (size_t)index * (size_t)recordSize + kNameBytes;
+    for (int i = 0; i < kNumParameters; i++)
+    {
+        uint32 bits;
+        memcpy(&bits, data + i * sizeof(float), sizeof(bits));
+        bits = ByteOrder::swapIfBigEndian(bits);
+        memcpy(&values[i], &bits, sizeof(float));
+        values[i] = jlimit(0.0f, 1.0f, values[i]);
+    }
+    return true;
+}
+
+bool PresetBank::write(const File& bankFile, const StringArray& names, const float* values)
+{
+    bankFile.deleteFile();
+    ScopedPointer<FileOutputStream> out = bankFile.createOutputStream();
+    if (out == nullptr) return false;
+
+    out->writeInt(bankMagic);
+    out->writeShort((short)bankVersion);
+    out->writeShort((short)kNumParameters);
+    out->writeInt((int)PluginParameters::getSchemaHash());
+    out->writeInt(names.size());
+    out->writeInt(getRecordSize());
+    out->writeRepeatedByte(0, (size_t)bankHeaderSize - 20);
+
+    for (int p = 0; p < names.size(); p++)
+    {
+        // names are truncated to whole characters which fit
+        String name = names[p];
+        while ((int)name.getNumBytesAsUTF8() > kNameBytes) name = name.dropLastCharacters(1);
+        out->write(name.toRawUTF8(), name.getNumBytesAsUTF8());
+        out->writeRepeatedByte(0, (size_t)kNameBytes - name.getNumBytesAsUTF8());
+
+        for (int i = 0; i < kNumParameters; i++)
+            out->writeFloat(jlimit(0.0f, 1.0f, values[p * kNumParameters + i]));
+        out->writeRepeatedByte(0, (size_t)(getRecordSize() - kNameBytes - kNumParameters * (int)sizeof(float)));
+    }
+
+    out->flush();
+    return out->getStatus().wasOk();
+}
@@ -0,0 +1,68 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include "PluginParameters.h"
+
+// A bank of presets in one memory-mapped binary file of fixed-size records. Opening a bank
+// maps the file and checks its header, whatever its size; pages are read from disk only when a
+// preset on them is first read, and any preset's values are found by index with no parsing.
+// Reading a preset can therefore wait for the disk, so it is never done on the audio thread:
+// the processor decodes presets into its own memory on the message thread.
+//
+// Format (little-endian): a 32-byte header (magic "APVP", version, number of parameters, the
+// parameter table's schema hash, number of presets, record size), then one record per preset:
+// a zero-padded UTF-8 name of kNameBytes, then one normalised float per parameter, in table
+// order, padded to a multiple of 16 bytes.
+class PresetBank
+{
+public:
+    PresetBank();
+
+    // Map a bank file, replacing any open one. Returns false (leaving the bank empty) if the
+    // file cannot be mapped, is not a bank, or was written with a different parameter table.
+    bool open(const File& bankFile);
+    void close();
+
+    int getNumPresets() const { return numPresets; }
+
+    // Preset name (message thread: creates a String)
+    String getName(int index) const;
+
+    // Decode a preset's kNumParameters normalised values into values; returns false if there
+    // is no such preset. May read from disk, so not for the audio thread.
+    bool getValues(int index, float* values) const;
+
+    // Write a bank: names.size() presets, with kNumParameters normalised values each in values
+    static bool write(const File& bankFile, const StringArray& names, const float* values);
+
+    static const int kNameBytes = 32;
+
+private:
+    ScopedPointer<MemoryMappedFile> mappedFile;
+    const char* records;
+    int numPresets;
+    int recordSize;
+
+    static int getRecordSize() { return (kNameBytes + kNumParameters * (int)sizeof(float) + 15) & ~15; }
+
+    JUCE_DECLARE_NON_COPYABLE(PresetBank)
+};
@@ -0,0 +1,294 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "RealtimeSafetyAudit.h"
+
+#if ! RT_SAFETY_AUDIT
+
+int RealtimeSafetyAudit::getNumViolations() { return 0; }
+void RealtimeSafetyAudit::reset() {}
+
+#else
+
+#include <cstdlib>
+
+#if ! (defined (__linux__) && defined (__GLIBC__))
+ #error "RT_SAFETY_AUDIT is only supported on Linux with glibc"
+#endif
+
+#include <atomic>
+#include <cstdarg>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    thread_local int sectionDepth = 0;      // > 0 while this thread is inside a ScopedSection
+    thread_local bool isReporting = false;  // guards against recursion while reporting
+    std::atomic<int> numViolations(0);
+    const int maxReports = 20;              // only the first few violations print stack traces
+
+    typedef ssize_t (*WriteFn)(int, const void*, size_t);
+    typedef ssize_t (*ReadFn)(int, void*, size_t);
+    typedef int (*MutexFn)(pthread_mutex_t*);
+    typedef int (*NanosleepFn)(const struct timespec*, struct timespec*);
+    typedef int (*UsleepFn)(useconds_t);
+    typedef int (*PosixMemalignFn)(void**, size_t, size_t);
+    typedef void* (*AlignedAllocFn)(size_t, size_t);
+    typedef int (*CondWaitFn)(pthread_cond_t*, pthread_mutex_t*);
+    typedef int (*CondTimedWaitFn)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+    typedef int (*SemWaitFn)(sem_t*);
+    typedef int (*SchedYieldFn)();
+    typedef int (*OpenFn)(const char*, int, ...);
+    typedef int (*CloseFn)(int);
+
+    WriteFn realWrite = nullptr;
+    ReadFn realRead = nullptr;
+    MutexFn realMutexLock = nullptr;
+    NanosleepFn realNanosleep = nullptr;
+    UsleepFn realUsleep = nullptr;
+    PosixMemalignFn realPosixMemalign = nullptr;
+    AlignedAllocFn realAlignedAlloc = nullptr;
+    AlignedAllocFn realMemalign = nullptr;
+    CondWaitFn realCondWait = nullptr;
+    CondTimedWaitFn realCondTimedWait = nullptr;
+    SemWaitFn realSemWait = nullptr;
+    SchedYieldFn realSchedYield = nullptr;
+    OpenFn realOpen = nullptr;
+    CloseFn realClose = nullptr;
+
+    void resolveRealFunctions()
+    {
+        if (realMutexLock != nullptr) return;
+        realWrite = (WriteFn)dlsym(RTLD_NEXT, "write");
+        realRead = (ReadFn)dlsym(RTLD_NEXT, "read");
+        realNanosleep = (NanosleepFn)dlsym(RTLD_NEXT, "nanosleep");
+        realUsleep = (UsleepFn)dlsym(RTLD_NEXT, "usleep");
+        realPosixMemalign = (PosixMemalignFn)dlsym(RTLD_NEXT, "posix_memalign");
+        realAlignedAlloc = (AlignedAllocFn)dlsym(RTLD_NEXT, "aligned_alloc");
+        realMemalign = (AlignedAllocFn)dlsym(RTLD_NEXT, "memalign");
+        // the versioned symbols, as an unversioned lookup may find glibc's old ABI
+        // (newer ports have only the one version)
+        realCondWait = (CondWaitFn)dlvsym(RTLD_NEXT, "pthread_cond_wait", "GLIBC_2.3.2");
+        if (realCondWait == nullptr) realCondWait = (CondWaitFn)dlsym(RTLD_NEXT, "pthread_cond_wait");
+        realCondTimedWait = (CondTimedWaitFn)dlvsym(RTLD_NEXT, "pthread_cond_timedwait", "GLIBC_2.3.2");
+        if (realCondTimedWait == nullptr) realCondTimedWait = (CondTimedWaitFn)dlsym(RTLD_NEXT, "pthread_cond_timedwait");
+        realSemWait = (SemWaitFn)dlsym(RTLD_NEXT, "sem_wait");
+        realSchedYield = (SchedYieldFn)dlsym(RTLD_NEXT, "sched_yield");
+        realOpen = (OpenFn)dlsym(RTLD_NEXT, "open");
+        realClose = (CloseFn)dlsym(RTLD_NEXT, "close");
+        realMutexLock = (MutexFn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+    }
+
+    // Resolve the real functions, and load the unwinder used by backtrace(), at static
+    // initialization time, so neither happens for the first time inside a real-time section
+    struct Initialiser
+    {
+        Initialiser()
+        {
+            resolveRealFunctions();
+            void* frames[1];
+            backtrace(frames, 1);
+        }
+    } initialiser;
+
+    void writeToStderr(const char* text)
+    {
+        if (realWrite != nullptr) realWrite(STDERR_FILENO, text, strlen(text));
+    }
+
+    void reportViolation(const char* functionName)
+    {
+        isReporting = true;
+        int n = ++numViolations;
+        if (n <= maxReports)
+        {
+            writeToStderr("*** Real-time safety violation: ");
+            writeToStderr(functionName);
+            writeToStderr(" called inside a real-time section\n");
+
+            void* frames[32];
+            int numFrames = backtrace(frames, 32);
+            backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+        }
+        isReporting = false;
+    }
+
+    inline void check(const char* functionName)
+    {
+        if (sectionDepth > 0 && !isReporting) reportViolation(functionName);
+    }
+}
+
+void RealtimeSafetyAudit::enterSection() { sectionDepth++; }
+void RealtimeSafetyAudit::exitSection() { sectionDepth--; }
+int RealtimeSafetyAudit::getNumViolations() { return numViolations.load(); }
+void RealtimeSafetyAudit::reset() { numViolations = 0; }
+
+// Interposed C library functions. Symbols defined in the executable take precedence over
+// those in shared libraries, so these also catch calls made from JUCE and the C++ runtime.
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        check("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size)
+    {
+        check("calloc");
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        check("realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr)
+    {
+        if (ptr != nullptr) check("free");
+        __libc_free(ptr);
+    }
+
+    int posix_memalign(void** ptr, size_t alignment, size_t size)
+    {
+        check("posix_memalign");
+        resolveRealFunctions();
+        return realPosixMemalign(ptr, alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        check("aligned_alloc");
+        resolveRealFunctions();
+        return realAlignedAlloc(alignment, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        check("memalign");
+        resolveRealFunctions();
+        return realMemalign(alignment, size);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        check("pthread_mutex_lock");
+        resolveRealFunctions();
+        return realMutexLock(mutex);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        check("pthread_cond_wait");
+        resolveRealFunctions();
+        return realCondWait(cond, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
+    {
+        check("pthread_cond_timedwait");
+        resolveRealFunctions();
+        return realCondTimedWait(cond, mutex, abstime);
+    }
+
+    int sem_wait(sem_t* sem)
+    {
+        check("sem_wait");
+        resolveRealFunctions();
+        return realSemWait(sem);
+    }
+
+    int sched_yield()
+    {
+        check("sched_yield");
+        resolveRealFunctions();
+        return realSchedYield();
+    }
+
+    int open(const char* path, int flags, ...)
+    {
+        check("open");
+        resolveRealFunctions();
+
+        // the mode argument is only passed when a file may be created
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+        return realOpen(path, flags, mode);
+    }
+
+    int close(int fd)
+    {
+        check("close");
+        resolveRealFunctions();
+        return realClose(fd);
+    }
+
+    ssize_t write(int fd, const void* buf, size_t count)
+    {
+        check("write");
+        resolveRealFunctions();
+        return realWrite(fd, buf, count);
+    }
+
+    ssize_t read(int fd, void* buf, size_t count)
+    {
+        check("read");
+        resolveRealFunctions();
+        return realRead(fd, buf, count);
+    }
+
+    int nanosleep(const struct timespec* req, struct timespec* rem)
+    {
+        check("nanosleep");
+        resolveRealFunctions();
+        return realNanosleep(req, rem);
+    }
+
+    int usleep(useconds_t usec)
+    {
+        check("usleep");
+        resolveRealFunctions();
+        return realUsleep(usec);
+    }
+}
+
+#endif
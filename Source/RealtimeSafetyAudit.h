@@ -0,0 +1,60 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+
+// Real-time safety audit, for test builds.
+// When compiled with RT_SAFETY_AUDIT=1 (supported on Linux with glibc), memory allocation
+// (malloc, calloc, realloc, free, posix_memalign, aligned_alloc, memalign), blocking
+// synchronisation (pthread_mutex_lock, pthread_cond_wait/timedwait, sem_wait, sched_yield) and
+// system calls (open, close, read, write, nanosleep, usleep) are intercepted, and any made by a
+// thread while it is inside a ScopedSection (e.g. during processBlock, or a voice task on a
+// worker thread) are counted and reported on stderr with a stack trace. In normal builds ScopedSection compiles to nothing.
+#ifndef RT_SAFETY_AUDIT
+ #define RT_SAFETY_AUDIT 0
+#endif
+
+class RealtimeSafetyAudit
+{
+public:
+    // Marks the calling thread as running real-time code for the lifetime of this object
+    class ScopedSection
+    {
+    public:
+       #if RT_SAFETY_AUDIT
+        ScopedSection() { enterSection(); }
+        ~ScopedSection() { exitSection(); }
+       #else
+        ScopedSection() {}
+       #endif
+    };
+
+    // True if this build intercepts calls (i.e. RT_SAFETY_AUDIT is enabled)
+    static bool isAvailable() { return RT_SAFETY_AUDIT != 0; }
+
+    // Number of violations recorded since the last reset()
+    static int getNumViolations();
+    static void reset();
+
+   #if RT_SAFETY_AUDIT
+    static void enterSection();
+    static void exitSection();
+   #endif
+};
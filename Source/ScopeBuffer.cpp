@@ -0,0 +1,87 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "ScopeBuffer.h"
+
+ScopeBuffer::ScopeBuffer()
+    : fifo(kFifoSize)
+    , enabled(false)
+    , current({ 0.0f, 0.0f })
+    , currentCount(0)
+{
+}
+
+void ScopeBuffer::prepare()
+{
+    fifo.reset();
+    currentCount = 0;
+}
+
+inline void ScopeBuffer::addSample(float sample, int& numWritten, int start1, int size1, int start2, int size2)
+{
+    if (currentCount == 0) current = { sample, sample };
+    else current = { jmin(current.min, sample), jmax(current.max, sample) };
+
+    if (++currentCount < kSamplesPerPeak) return;
+    currentCount = 0;
+
+    if (numWritten < size1) peaks[start1 + numWritten++] = current;
+    else if (numWritten < size1 + size2) peaks[start2 + (numWritten++ - size1)] = current;
+}
+
+template <typename SampleType>
+void ScopeBuffer::pushBlock(const SampleType* samples, int numSamples)
+{
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite((currentCount + numSamples) / kSamplesPerPeak, start1, size1, start2, size2);
+
+    int numWritten = 0;
+    for (int i = 0; i < numSamples; i++)
+        addSample((float)samples[i], numWritten, start1, size1, start2, size2);
+    fifo.finishedWrite(numWritten);
+}
+
+void ScopeBuffer::pushSilence(int numSamples)
+{
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite((currentCount + numSamples) / kSamplesPerPeak, start1, size1, start2, size2);
+
+    int numWritten = 0;
+    for (int i = 0; i < numSamples; i++)
+        addSample(0.0f, numWritten, start1, size1, start2, size2);
+    fifo.finishedWrite(numWritten);
+}
+
+int ScopeBuffer::readPeaks(Peak* dest, int maxNum)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxNum, start1, size1, start2, size2);
+    if (size1 > 0) memcpy(dest, peaks + start1, size1 * sizeof(Peak));
+    if (size2 > 0) memcpy(dest + size1, peaks + start2, size2 * sizeof(Peak));
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+template void ScopeBuffer::pushBlock<float>(const float*, int);
+template void ScopeBuffer::pushBlock<double>(const double*, int);
@@ -0,0 +1,69 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+// Decimated copy of the synth's output, for the editor's oscilloscope.
+// The audio thread pushes each block; every kSamplesPerPeak samples become one (min, max) peak
+// pair in a lock-free single-producer, single-consumer FIFO, which the message thread drains
+// with readPeaks(). Capture is off unless a reader has enabled it, so with no scope showing,
+// pushBlock() costs one relaxed atomic load. If the FIFO is full, new peaks are dropped.
+class ScopeBuffer
+{
+public:
+    struct Peak
+    {
+        float min, max;
+    };
+
+    ScopeBuffer();
+
+    // Call from prepareToPlay()
+    void prepare();
+
+    // Message thread: start or stop capturing
+    void setEnabled(bool shouldCapture) { enabled.store(shouldCapture); }
+
+    // Audio thread: capture numSamples samples, or that many samples of silence
+    template <typename SampleType>
+    void pushBlock(const SampleType* samples, int numSamples);
+    void pushSilence(int numSamples);
+
+    // Message thread: copies up to maxNum pending peaks into dest, returns the number copied
+    int readPeaks(Peak* dest, int maxNum);
+
+    static const int kSamplesPerPeak = 4;
+    static const int kFifoSize = 8192;
+
+private:
+    AbstractFifo fifo;
+    Peak peaks[kFifoSize];
+    std::atomic<bool> enabled;
+
+    // peak being accumulated, carried over between blocks
+    Peak current;
+    int currentCount;
+
+    void addSample(float sample, int& numWritten, int start1, int size1, int start2, int size2);
+
+    JUCE_DECLARE_NON_COPYABLE(ScopeBuffer)
+};
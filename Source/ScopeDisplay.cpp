@@ -0,0 +1,129 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "ScopeDisplay.h"
+
+static const int textHeight = 20;
+static const float verticalRange = 2.0f;
+
+ScopeDisplay::ScopeDisplay(ScopeBuffer& buffer)
+    : scopeBuffer(buffer)
+    , history((size_t)kHistorySize, true)
+    , historyWritePos(0)
+{
+    setOpaque(true);
+    scopeBuffer.setEnabled(true);
+    startTimerHz(kRefreshRateHz);
+}
+
+ScopeDisplay::~ScopeDisplay()
+{
+    scopeBuffer.setEnabled(false);
+}
+
+Rectangle<int> ScopeDisplay::getTraceArea() const
+{
+    return getLocalBounds().withTrimmedTop(textHeight);
+}
+
+void ScopeDisplay::timerCallback()
+{
+    // drain everything pending into the history ring
+    int numRead = 0;
+    for (;;)
+    {
+        const int n = scopeBuffer.readPeaks(history + historyWritePos, kHistorySize - historyWritePos);
+        if (n == 0) break;
+        historyWritePos = (historyWritePos + n) & (kHistorySize - 1);
+        numRead += n;
+    }
+
+    if (numRead > 0)
+    {
+        updatePath();
+        repaint(getTraceArea());
+    }
+}
+
+void ScopeDisplay::resized()
+{
+    updatePath();
+}
+
+void ScopeDisplay::updatePath()
+{
+    const Rectangle<int> area = getTraceArea();
+    const int width = jmin(area.getWidth(), kHistorySize / 2);
+    trace.clear();
+    if (width < 2) return;
+
+    auto peakAt = [this](int age) -> const ScopeBuffer::Peak& { return history[(historyWritePos - 1 - age) & (kHistorySize - 1)]; };
+
+    // Find the most recent rising zero crossing which leaves a full screen of peaks after it;
+    // if there is none (silence, or a very low note), show the most recent peaks
+    int start = width - 1;
+    for (int age = width; age < kHistorySize - 1; age++)
+    {
+        const ScopeBuffer::Peak& before = peakAt(age + 1);
+        const ScopeBuffer::Peak& after = peakAt(age);
+        if (before.min + before.max < 0.0f && after.min + after.max >= 0.0f)
+        {
+            start = age;
+            break;
+        }
+    }
+
+    const float x0 = (float)area.getX();
+    const float yCentre = (float)area.getCentreY();
+    const float yScale = area.getHeight() / (2.0f * verticalRange);
+    auto y = [=](float value) { return yCentre - yScale * jlimit(-verticalRange, verticalRange, value); };
+
+    // outline: along the maxima left to right, then back along the minima
+    trace.preallocateSpace(4 * width + 4);
+    trace.startNewSubPath(x0, y(peakAt(start).max));
+    for (int x = 1; x < width; x++)
+        trace.lineTo(x0 + x, y(peakAt(start - x).max));
+    for (int x = width - 1; x >= 0; x--)
+        trace.lineTo(x0 + x, y(peakAt(start - x).min) + 1.0f);
+    trace.closeSubPath();
+}
+
+void ScopeDisplay::paint(Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));
+
+    Rectangle<int> area = getLocalBounds();
+    g.setColour(Colours::white);
+    g.setFont(14.0f);
+    g.drawText(TRANS("Output"), area.removeFromTop(textHeight), Justification::centredLeft);
+
+    g.setColour(Colours::darkgrey);
+    g.fillRect(area);
+
+    // centre line, and full scale (level 1.0) lines
+    const float yScale = area.getHeight() / (2.0f * verticalRange);
+    g.setColour(Colours::grey);
+    g.drawHorizontalLine(area.getCentreY(), (float)area.getX(), (float)area.getRight());
+    g.drawHorizontalLine(roundToInt(area.getCentreY() - yScale), (float)area.getX(), (float)area.getRight());
+    g.drawHorizontalLine(roundToInt(area.getCentreY() + yScale), (float)area.getX(), (float)area.getRight());
+
+    g.setColour(Colours::lightgreen);
+    g.fillPath(trace);
+}
@@ -0,0 +1,56 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include "ScopeBuffer.h"
+
+// Editor component showing the synth's output as an oscilloscope trace: one (min, max) peak
+// pair per pixel column, started at a rising zero crossing so a steady tone stands still.
+// The vertical range is -2 to +2, with lines at -1 and +1, so the "loud" doubling shows.
+// Enables the ScopeBuffer's capture while it exists. On its own timer it drains the buffer,
+// rebuilds a cached Path, and repaints only the trace area; paint() just fills the Path.
+class ScopeDisplay : public Component, private Timer
+{
+public:
+    ScopeDisplay(ScopeBuffer& buffer);
+    ~ScopeDisplay();
+
+    void paint(Graphics&) override;
+    void resized() override;
+
+    static const int kRefreshRateHz = 30;
+    static const int kHistorySize = 4096;   // peaks kept, a power of two
+
+private:
+    void timerCallback() override;
+    void updatePath();
+    Rectangle<int> getTraceArea() const;
+
+    ScopeBuffer& scopeBuffer;
+
+    // most recent peaks, as a ring
+    HeapBlock<ScopeBuffer::Peak> history;
+    int historyWritePos;
+
+    Path trace;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeDisplay)
+};
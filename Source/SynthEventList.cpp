@@ -0,0 +1,88 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SynthEventList.h"
+
+void SynthEventList::prepare(int maxEvents)
+{
+    if (maxEvents != capacity)
+    {
+        capacity = maxEvents;
+        events.allocate(capacity, true);
+    }
+    numEvents = 0;
+}
+
+void SynthEventList::add(const SynthEvent& event)
+{
+    if (numEvents >= capacity)
+    {
+        // List is full: increase the capacity passed to prepare()
+        jassertfalse;
+        return;
+    }
+
+    // Insertion from the back: O(1) for events which arrive in order, as MIDI events do
+    int i = numEvents++;
+    while (i > 0 && events[i - 1].sampleOffset > event.sampleOffset)
+    {
+        events[i] = events[i - 1];
+        i--;
+    }
+    events[i] = event;
+}
+
+void SynthEventList::addMidiEvents(const MidiBuffer& midiMessages, int numSamples)
+{
+    MidiBuffer::Iterator it(midiMessages);
+    MidiMessage msg;
+    int samplePos;
+    while (it.getNextEvent(msg, samplePos))
+    {
+        SynthEvent event;
+        event.sampleOffset = jlimit(0, jmax(0, numSamples - 1), samplePos);
+        event.noteNumber = 0;
+        event.velocity = 0.0f;
+
+        if (msg.isNoteOn())
+        {
+            event.type = SynthEvent::kNoteOn;
+            event.noteNumber = msg.getNoteNumber();
+            event.velocity = msg.getFloatVelocity();
+        }
+        else if (msg.isNoteOff())
+        {
+            event.type = SynthEvent::kNoteOff;
+            event.noteNumber = msg.getNoteNumber();
+        }
+        else if (msg.isAllNotesOff() || msg.isAllSoundOff())
+        {
+            event.type = SynthEvent::kAllNotesOff;
+        }
+        else if (msg.isProgramChange())
+        {
+            event.type = SynthEvent::kProgramChange;
+            event.noteNumber = msg.getProgramChangeNumber();
+        }
+        else continue;
+
+        add(event);
+    }
+}
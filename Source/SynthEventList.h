@@ -0,0 +1,62 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// A timestamped synthesis event, e.g. a MIDI note-on at a given sample offset within the block
+struct SynthEvent
+{
+    enum Type { kNoteOn, kNoteOff, kAllNotesOff, kProgramChange };
+
+    int sampleOffset;       // position within the current block
+    Type type;
+    int noteNumber;         // or program number, for kProgramChange
+    float velocity;
+};
+
+// Fixed-capacity list of SynthEvents, kept sorted by sampleOffset.
+// Storage is allocated once in prepare(); add() never allocates, so it is safe to fill the
+// list on the audio thread. Events which arrive when the list is full are dropped.
+class SynthEventList
+{
+public:
+    SynthEventList() : capacity(0), numEvents(0) {}
+
+    // Allocate storage (call from prepareToPlay, never from the audio thread)
+    void prepare(int maxEvents);
+
+    void clear() { numEvents = 0; }
+
+    // Insert an event, keeping the list sorted; events with equal offsets keep their order
+    void add(const SynthEvent& event);
+
+    // Convert the block's MIDI events we respond to, clamping offsets to [0, numSamples)
+    void addMidiEvents(const MidiBuffer& midiMessages, int numSamples);
+
+    int size() const { return numEvents; }
+    const SynthEvent& operator[](int i) const { return events[i]; }
+
+private:
+    HeapBlock<SynthEvent> events;
+    int capacity, numEvents;
+
+    JUCE_DECLARE_NON_COPYABLE(SynthEventList)
+};
@@ -19,30 +19,110 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "SynthOscillator.h"
-#include <cmath>
-#include "../JuceLibraryCode/JuceHeader.h"    // only for double_Pi constant
 
-float SynthOscillator::getSample()
+void SynthOscillator::setSmoothingSamples(int numSamples)
 {
-    float sample = 0.0f;
-    switch (waveform.index)
+    glideLength = numSamples;
+    gain.setRampLength(numSamples);
+}
+
+void SynthOscillator::resetSmoothing(float newGain)
+{
+    finishGlide();
+    gain.snapTo(newGain);
+}
+
+void SynthOscillator::finishGlide()
+{
+    phaseDelta = glideStartDelta = targetDelta;
+    deltaStep = 0;
+    glideSamplesRemaining = glideElapsed = 0;
+}
+
+void SynthOscillator::setFrequency(double cyclesPerSample)
+{
+    const uint64 newDelta = SynthWavetable::toFixed(cyclesPerSample);
+    if (newDelta == targetDelta) return;
+
+    targetDelta = newDelta;
+    if (glideLength <= 0)
+    {
+        finishGlide();
+        return;
+    }
+
+    // deltas are below 2^63 (i.e. below Nyquist), so their difference fits in an int64
+    glideStartDelta = phaseDelta;
+    deltaStep = ((int64)targetDelta - (int64)phaseDelta) / glideLength;
+    glideSamplesRemaining = glideLength;
+    glideElapsed = 0;
+}
+
+void SynthOscillator::advanceGlide(int numSamples)
+{
+    glideSamplesRemaining -= numSamples;
+    glideElapsed += numSamples;
+    if (glideSamplesRemaining <= 0) finishGlide();
+    else phaseDelta = glideStartDelta + (uint64)(glideElapsed * deltaStep);
+}
+
+template <typename SampleType>
+void SynthOscillator::renderBlock(SampleType* dest, int numSamples, float newGain)
+{
+    gain.setTarget(newGain);
+
+    // Render ramped segments (each ending where a ramp ends), then the flat remainder
+    while (numSamples > 0 && (gain.isRamping() || isGliding()))
     {
-    case SynthWaveform::kSine:
-        sample = (float)(std::sin(phase * 2.0 * double_Pi));
-        break;
-    case SynthWaveform::kSquare:
-        sample = (phase <= 0.5) ? 1.0f : -1.0f;
-        break;
-    case SynthWaveform::kTriangle:
-        sample = (float)(2.0 * (0.5 - std::fabs(phase - 0.5)) - 1.0);
-        break;
-    case SynthWaveform::kSawtooth:
-        sample = (float)(2.0 * phase - 1.0);
-        break;
+        int n = numSamples;
+        if (gain.isRamping()) n = jmin(n, gain.stepsRemaining);
+        if (isGliding()) n = jmin(n, glideSamplesRemaining);
+
+        // choose the table for the highest frequency of the whole glide, so it cannot alias,
+        // and so the choice does not depend on where blocks begin and end
+        const uint64 maxDelta = isGliding() ? jmax(glideStartDelta, targetDelta) : phaseDelta;
+        const float* table = SynthWavetable::getInstance().getTable(waveform, SynthWavetable::fromFixed(maxDelta));
+        const int64 step = isGliding() ? deltaStep : 0;
+        SynthWavetable::renderBlockFixedRamped(table, dest, n, phase, phaseDelta, step,
+                                               (SampleType)gain.start, (SampleType)gain.step, gain.elapsed);
+
+        phase = SynthWavetable::rampedPhaseFixed(phase, phaseDelta, step, n);
+        if (isGliding()) advanceGlide(n);
+        gain.advance(n);
+        dest += n;
+        numSamples -= n;
     }
 
-    phase += phaseDelta;
-    while (phase > 1.0) phase -= 1.0;
+    if (numSamples > 0)
+    {
+        const float* table = SynthWavetable::getInstance().getTable(waveform, SynthWavetable::fromFixed(phaseDelta));
+        SynthWavetable::renderBlockFixed(table, dest, numSamples, phase, phaseDelta, (SampleType)gain.current);
+
+        phase += (uint64)numSamples * phaseDelta;
+    }
+}
 
-    return sample;
+template void SynthOscillator::renderBlock<float>(float*, int, float);
+template void SynthOscillator::renderBlock<double>(double*, int, float);
+
+void SynthOscillator::skipBlock(int numSamples, float newGain)
+{
+    gain.setTarget(newGain);
+    gain.advance(jmin(numSamples, gain.stepsRemaining));
+
+    // closed-form phase over the remainder of any glide, then at the constant rate
+    int n = 0;
+    if (isGliding())
+    {
+        n = jmin(numSamples, glideSamplesRemaining);
+        phase = SynthWavetable::rampedPhaseFixed(phase, phaseDelta, deltaStep, n);
+        advanceGlide(n);
+    }
+    phase += (uint64)(numSamples - n) * phaseDelta;
+}
+
+void SynthOscillator::seekToSample(int64 samplePosition)
+{
+    finishGlide();
+    phase = (uint64)samplePosition * phaseDelta;
 }
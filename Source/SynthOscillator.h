@@ -20,19 +20,64 @@ THE SOFTWARE.
 */
 #pragma once
 #include "SynthWaveform.h"
+#include "SynthWavetable.h"
+#include "SynthRamp.h"
 
 class SynthOscillator
 {
 private:
     SynthWaveform waveform;
-    double phase;           // [0.0, 1.0]
-    double phaseDelta;      // cycles per sample (fraction)
+
+    // Phase and frequency are fixed-point (see SynthWavetable::toFixed), so the phase is exact:
+    // it never drifts, and is the same however rendering is divided into blocks.
+    uint64 phase;               // fraction of a cycle
+    uint64 phaseDelta;          // cycles per sample
+    uint64 glideStartDelta;     // phaseDelta when the current glide started
+    uint64 targetDelta;         // phaseDelta at the end of the glide
+    int64 deltaStep;            // change of phaseDelta per sample while gliding
+    int glideSamplesRemaining, glideElapsed, glideLength;
+
+    SynthRamp gain;         // output gain, ramps to avoid zipper noise
+
+    bool isGliding() const { return glideSamplesRemaining > 0; }
+    void advanceGlide(int numSamples);
+    void finishGlide();
 
 public:
-    SynthOscillator() : phase(0), phaseDelta(0) {}
+    SynthOscillator()
+        : phase(0), phaseDelta(0), glideStartDelta(0), targetDelta(0), deltaStep(0)
+        , glideSamplesRemaining(0), glideElapsed(0), glideLength(0)
+    {
+        // make sure the shared wavetables are built now, rather than on the audio thread
+        SynthWavetable::getInstance();
+    }
     
     void setWaveform(SynthWaveform wf) { waveform = wf; }
-    void setFrequency(double cyclesPerSample) { phaseDelta = cyclesPerSample; }
 
-    float getSample ();
+    // Set a new frequency; if a smoothing time is set, the pitch glides there
+    void setFrequency(double cyclesPerSample);
+
+    // Set the length of gain ramps and pitch glides, in samples (0 to disable)
+    void setSmoothingSamples(int numSamples);
+
+    // Jump to the current target frequency and the given gain, cancelling any ramps
+    void resetSmoothing(float newGain);
+
+    // Render numSamples samples, scaled by gain, into dest (overwriting its contents).
+    // A change of gain (or of frequency) ramps over the smoothing time; while no ramp is active,
+    // the flat constant-gain kernel is used. SampleType is float or double.
+    template <typename SampleType>
+    void renderBlock(SampleType* dest, int numSamples, float gain);
+
+    // True if the gain is zero and not ramping, so renderBlock() at zero gain would be silent
+    bool isSilent() const { return gain.current == 0.0 && !gain.isRamping(); }
+
+    // Advance by numSamples as renderBlock() would, without rendering anything: the phase is
+    // advanced analytically, in constant time, so the waveform stays continuous
+    void skipBlock(int numSamples, float gain);
+
+    // Place the phase exactly where it would be after rendering samplePosition samples at
+    // the current frequency from phase zero, in constant time (e.g. after a transport jump).
+    // Any glide in progress is completed first.
+    void seekToSample(int64 samplePosition);
 };
@@ -0,0 +1,147 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SynthOversampler.h"
+
+template <typename SampleType>
+SynthHalfBandDecimator<SampleType>::SynthHalfBandDecimator()
+    : numPairs(0)
+{
+}
+
+template <typename SampleType>
+void SynthHalfBandDecimator<SampleType>::prepare(int K, int maxOutputSamples)
+{
+    numPairs = K;
+    coeffs.allocate(K, true);
+    even.allocate(2 * K + maxOutputSamples, true);
+    odd.allocate(2 * K + maxOutputSamples, true);
+
+    // Blackman-windowed sinc with cutoff at a quarter of the input rate. Tap at offset j
+    // from the centre is sin(pi*j/2)/(pi*j), nonzero only for odd j; coeffs[q] is the tap at
+    // offset 2(K-q)-1, i.e. outermost first.
+    const int halfLength = 2 * K - 1;
+    double sum = 0.0;
+    for (int q = 0; q < K; q++)
+    {
+        const int j = halfLength - 2 * q;
+        const double x = (double)(halfLength - j + 1) / (2 * halfLength + 2);  // window position, 0..0.5
+        const double window = 0.42 - 0.5 * std::cos(2.0 * double_Pi * x) + 0.08 * std::cos(4.0 * double_Pi * x);
+        const double h = std::sin(double_Pi * j / 2.0) / (double_Pi * j) * window;
+        coeffs[q] = (SampleType)h;
+        sum += 2.0 * h;
+    }
+
+    // normalise for unity gain at DC; the centre tap is fixed at 0.5
+    for (int q = 0; q < K; q++) coeffs[q] = (SampleType)(coeffs[q] * 0.5 / sum);
+
+    reset();
+}
+
+template <typename SampleType>
+void SynthHalfBandDecimator<SampleType>::reset()
+{
+    FloatVectorOperations::clear(even.get(), 2 * numPairs);
+    FloatVectorOperations::clear(odd.get(), 2 * numPairs);
+}
+
+template <typename SampleType>
+void SynthHalfBandDecimator<SampleType>::process(const SampleType* input, SampleType* output, int numOut)
+{
+    const int K = numPairs;
+
+    // split new input into phases, after 2K samples of history
+    for (int i = 0; i < numOut; i++)
+    {
+        even[2 * K + i] = input[2 * i];
+        odd[2 * K + i] = input[2 * i + 1];
+    }
+
+    // y[m] = 0.5 * odd[m + K] + sum over q of coeffs[q] * (even[m + 1 + q] + even[m + 2K - q])
+    FloatVectorOperations::copyWithMultiply(output, odd + K, (SampleType)0.5, numOut);
+    for (int q = 0; q < K; q++)
+    {
+        FloatVectorOperations::addWithMultiply(output, even + 1 + q, coeffs[q], numOut);
+        FloatVectorOperations::addWithMultiply(output, even + 2 * K - q, coeffs[q], numOut);
+    }
+
+    // keep the last 2K samples of each phase as history
+    memmove(even.get(), even + numOut, 2 * K * sizeof(SampleType));
+    memmove(odd.get(), odd + numOut, 2 * K * sizeof(SampleType));
+}
+
+
+template <typename SampleType>
+const int SynthOversampler<SampleType>::stageTapPairs[kMaxFactorLog2] = { 16, 8, 6 };
+
+template <typename SampleType>
+SynthOversampler<SampleType>::SynthOversampler()
+    : factorLog2(0)
+    , maxBlockSize(0)
+{
+}
+
+template <typename SampleType>
+void SynthOversampler<SampleType>::prepare(int maxBlock)
+{
+    maxBlockSize = jmax(1, maxBlock);
+    buffer.allocate(maxBlockSize << kMaxFactorLog2, true);
+    for (int s = 0; s < kMaxFactorLog2; s++)
+        stages[s].prepare(stageTapPairs[s], maxBlockSize << s);
+}
+
+template <typename SampleType>
+void SynthOversampler<SampleType>::setFactorLog2(int log2)
+{
+    log2 = jlimit(0, kMaxFactorLog2, log2);
+    if (log2 == factorLog2) return;
+
+    factorLog2 = log2;
+    reset();
+}
+
+template <typename SampleType>
+void SynthOversampler<SampleType>::decimate(SampleType* dest, int numSamples)
+{
+    if (factorLog2 == 0)
+    {
+        FloatVectorOperations::copy(dest, buffer.get(), numSamples);
+        return;
+    }
+
+    // decimate in place, from the highest rate down; the last stage writes to dest
+    for (int s = factorLog2 - 1; s >= 0; s--)
+        stages[s].process(buffer, s == 0 ? dest : buffer.get(), numSamples << s);
+}
+
+template <typename SampleType>
+double SynthOversampler<SampleType>::getLatencySamples(int log2)
+{
+    // stage s delays by (2K - 1) samples at its input rate, (2 << s) x the host rate
+    double latency = 0.0;
+    for (int s = 0; s < log2; s++)
+        latency += (2 * stageTapPairs[s] - 1) / (double)(2 << s);
+    return latency;
+}
+
+template class SynthHalfBandDecimator<float>;
+template class SynthHalfBandDecimator<double>;
+template class SynthOversampler<float>;
+template class SynthOversampler<double>;
@@ -0,0 +1,108 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// Decimates by 2 with a linear-phase half-band FIR, in polyphase form.
+// A half-band filter's even-offset taps are zero except the centre tap, so each output sample
+// needs only the K symmetric pairs of odd-offset taps applied to every other input sample,
+// plus the centre tap applied to the rest. Input is split into those two phases, and each
+// tap pair is then applied across the whole block with FloatVectorOperations (SIMD).
+// SampleType is float or double.
+template <typename SampleType>
+class SynthHalfBandDecimator
+{
+public:
+    SynthHalfBandDecimator();
+
+    // Design the filter (4K-1 taps) and allocate for up to maxOutputSamples per call
+    // (call from prepareToPlay, never from the audio thread)
+    void prepare(int numTapPairs, int maxOutputSamples);
+    void reset();
+
+    // Consume 2*numOutputSamples samples from input and write numOutputSamples to output.
+    // output may be the same buffer as input.
+    void process(const SampleType* input, SampleType* output, int numOutputSamples);
+
+    // Group delay, in input samples
+    int getLatency() const { return 2 * numPairs - 1; }
+
+private:
+    int numPairs;               // K
+    HeapBlock<SampleType> coeffs;   // K odd-offset taps, outermost first
+    HeapBlock<SampleType> even;     // 2K history + new even-phase input samples
+    HeapBlock<SampleType> odd;      // 2K history + new odd-phase input samples
+
+    JUCE_DECLARE_NON_COPYABLE(SynthHalfBandDecimator)
+};
+
+// Renders at 1x, 2x, 4x or 8x the host rate, then decimates back to the host rate through
+// a cascade of half-band stages. The caller renders into getBuffer() at the oversampled rate,
+// and decimate() writes the host-rate result. All storage is allocated for 8x in prepare(),
+// so the factor can be changed from the audio thread. SampleType is float or double.
+template <typename SampleType>
+class SynthOversampler
+{
+public:
+    SynthOversampler();
+
+    // Allocate for blocks of up to maxBlockSize host-rate samples
+    void prepare(int maxBlockSize);
+
+    // Set the factor as a power of two (0..kMaxFactorLog2); clears the filter states on change
+    void setFactorLog2(int log2);
+    int getFactorLog2() const { return factorLog2; }
+
+    // Clear the filter states, e.g. after a stretch of silence
+    void reset() { for (auto& stage : stages) stage.reset(); }
+    int getFactor() const { return 1 << factorLog2; }
+
+    int getMaxBlockSize() const { return maxBlockSize; }
+
+    // Buffer to render getFactor() * numSamples oversampled samples into
+    SampleType* getBuffer() { return buffer; }
+
+    // Decimate the oversampled contents of getBuffer() into numSamples (<= getMaxBlockSize())
+    // host-rate samples in dest
+    void decimate(SampleType* dest, int numSamples);
+
+    // Total filter delay, in host-rate samples, for a given factor
+    static double getLatencySamples(int log2);
+
+    // Host-rate samples for which the filters can still produce output after their input
+    // becomes silent (the cascade's impulse response is symmetric about the latency)
+    static int getTailSamples(int log2) { return log2 == 0 ? 0 : (int)std::ceil(2.0 * getLatencySamples(log2)) + 1; }
+
+    static const int kMaxFactorLog2 = 3;
+
+private:
+    int factorLog2, maxBlockSize;
+    HeapBlock<SampleType> buffer;
+
+    // stages[s] decimates from (2 << s) x to (1 << s) x the host rate
+    SynthHalfBandDecimator<SampleType> stages[kMaxFactorLog2];
+
+    // Tap pairs per stage. The stage nearest the host rate needs the sharpest transition;
+    // later stages only have to keep their images out of the final passband.
+    static const int stageTapPairs[kMaxFactorLog2];
+
+    JUCE_DECLARE_NON_COPYABLE(SynthOversampler)
+};
@@ -0,0 +1,74 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+
+// Linear ramp toward a target value over a fixed number of samples.
+// The ramp is described by (current, step, stepsRemaining) rather than advanced sample by
+// sample, so block renderers can evaluate current + i * step directly in vectorized loops.
+// current is always recomputed as start + elapsed * step, never accumulated, so its value
+// at any sample is the same however the ramp is divided into blocks.
+struct SynthRamp
+{
+    double current, target, step;
+    int stepsRemaining, rampLength;
+    double start;   // value at the start of the ramp
+    int elapsed;    // samples since the start of the ramp
+
+    SynthRamp() : current(0), target(0), step(0), stepsRemaining(0), rampLength(0), start(0), elapsed(0) {}
+
+    // Set the ramp duration in samples; 0 means changes take effect immediately
+    void setRampLength(int numSamples) { rampLength = numSamples; }
+
+    // Jump straight to a value, cancelling any ramp in progress
+    void snapTo(double value)
+    {
+        current = target = start = value;
+        step = 0.0;
+        stepsRemaining = 0;
+        elapsed = 0;
+    }
+
+    // Start ramping toward a new target, unless it is already the target
+    void setTarget(double value)
+    {
+        if (value == target) return;
+        if (rampLength <= 0) { snapTo(value); return; }
+
+        target = value;
+        start = current;
+        elapsed = 0;
+        stepsRemaining = rampLength;
+        step = (target - current) / rampLength;
+    }
+
+    bool isRamping() const { return stepsRemaining > 0; }
+
+    // Advance by numSamples (no more than stepsRemaining, if ramping)
+    void advance(int numSamples)
+    {
+        if (!isRamping()) return;
+
+        stepsRemaining -= numSamples;
+        elapsed += numSamples;
+        if (stepsRemaining <= 0) snapTo(target);
+        else current = start + elapsed * step;
+    }
+};
@@ -0,0 +1,325 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SynthVoicePool.h"
+
+SynthVoicePool::SynthVoicePool()
+    : maxVoicesRequested(32)
+    , maxVoices(0)
+    , numActive(0)
+    , numLanes(0)
+    , voiceRampSamples(0)
+    , sampleRate(44100.0)
+    , noteCounter(0)
+    , workerPool(nullptr)
+    , parallelThreshold(0)
+    , maxTasks(0)
+{
+}
+
+void SynthVoicePool::prepare(double sr)
+{
+    sampleRate = sr;
+    numActive = 0;
+
+    if (maxVoices != maxVoicesRequested)
+    {
+        maxVoices = maxVoicesRequested;
+        numLanes = 2 * maxVoices;
+        phase.allocate(numLanes, true);
+        phaseDelta.allocate(numLanes, true);
+        gain.allocate(numLanes, true);
+        gainStep.allocate(numLanes, true);
+        targetGain.allocate(numLanes, true);
+        rampRemaining.allocate(numLanes, true);
+        releasing.allocate(numLanes, true);
+        waveform.allocate(numLanes, true);
+        noteNumber.allocate(numLanes, true);
+        startOrder.allocate(numLanes, true);
+    }
+}
+
+void SynthVoicePool::setWorkerPool(SynthWorkerPool* workers, int minVoices)
+{
+    workerPool = (workers != nullptr && workers->getNumWorkers() > 0) ? workers : nullptr;
+    parallelThreshold = jmax(1, minVoices);
+
+    // two tasks per thread, to even out ranges which finish at different times
+    const int numTasks = workerPool != nullptr ? 2 * (workerPool->getNumWorkers() + 1) : 0;
+    if (numTasks != maxTasks)
+    {
+        maxTasks = numTasks;
+        partialsFloat.allocate(maxTasks * kPartialSamples, true);
+        partialsDouble.allocate(maxTasks * kPartialSamples, true);
+    }
+}
+
+void SynthVoicePool::setSampleRate(double newSampleRate)
+{
+    const double ratio = sampleRate / newSampleRate;
+    for (int v = 0; v < numActive; v++) phaseDelta[v] *= ratio;
+    sampleRate = newSampleRate;
+}
+
+void SynthVoicePool::noteOn(int nn, float velocity, SynthWaveform wf)
+{
+    if (maxVoices == 0) return;
+
+    // Pool is full: release the voice which started earliest, to fade out in a spare lane
+    int numSounding = 0, oldest = -1;
+    for (int v = 0; v < numActive; v++)
+    {
+        if (releasing[v]) continue;
+        numSounding++;
+        if (oldest < 0 || startOrder[v] < startOrder[oldest]) oldest = v;
+    }
+    if (numSounding >= maxVoices) releaseVoice(oldest);
+
+    int v = numActive;
+    if (numActive < numLanes)
+    {
+        numActive++;
+    }
+    else
+    {
+        // Every lane is in use (voices are being stolen faster than they fade out): reuse
+        // the fading voice nearest to silence
+        v = -1;
+        for (int i = 0; i < numActive; i++)
+            if (releasing[i] && (v < 0 || gain[i] < gain[v])) v = i;
+    }
+
+    phase[v] = 0.0;
+    phaseDelta[v] = MidiMessage::getMidiNoteInHertz(nn) / sampleRate;
+    waveform[v] = wf.getIndex();
+    noteNumber[v] = nn;
+    startOrder[v] = noteCounter++;
+    releasing[v] = 0;
+    gain[v] = 0.0f;
+    startFade(v, velocity);
+}
+
+void SynthVoicePool::noteOff(int nn)
+{
+    for (int v = 0; v < numActive; v++)
+        if (noteNumber[v] == nn && !releasing[v]) releaseVoice(v);
+}
+
+void SynthVoicePool::allNotesOff()
+{
+    for (int v = 0; v < numActive; v++)
+        if (!releasing[v]) releaseVoice(v);
+}
+
+void SynthVoicePool::startFade(int v, float target)
+{
+    targetGain[v] = target;
+    if (voiceRampSamples > 0)
+    {
+        rampRemaining[v] = voiceRampSamples;
+        gainStep[v] = (target - gain[v]) / voiceRampSamples;
+    }
+    else
+    {
+        rampRemaining[v] = 0;
+        gainStep[v] = 0.0f;
+        gain[v] = target;
+    }
+}
+
+void SynthVoicePool::releaseVoice(int v)
+{
+    releasing[v] = 1;
+    startFade(v, 0.0f);
+}
+
+// Advance the fades of voices [firstVoice, endVoice) by numSamples
+void SynthVoicePool::advanceFades(int firstVoice, int endVoice, int numSamples)
+{
+    for (int v = firstVoice; v < endVoice; v++)
+    {
+        if (rampRemaining[v] == 0) continue;
+
+        const int n = jmin(numSamples, rampRemaining[v]);
+        gain[v] += n * gainStep[v];
+        rampRemaining[v] -= n;
+        if (rampRemaining[v] == 0) gain[v] = targetGain[v];
+    }
+}
+
+// Remove released voices whose fades have finished (not while voices are being rendered)
+void SynthVoicePool::removeFinishedVoices()
+{
+    for (int v = numActive - 1; v >= 0; v--)
+        if (releasing[v] && rampRemaining[v] == 0) removeVoice(v);
+}
+
+void SynthVoicePool::removeVoice(int v)
+{
+    // Keep active voices packed: move the last active voice into the vacated lane
+    int last = --numActive;
+    if (v != last)
+    {
+        phase[v] = phase[last];
+        phaseDelta[v] = phaseDelta[last];
+        gain[v] = gain[last];
+        gainStep[v] = gainStep[last];
+        targetGain[v] = targetGain[last];
+        rampRemaining[v] = rampRemaining[last];
+        releasing[v] = releasing[last];
+        waveform[v] = waveform[last];
+        noteNumber[v] = noteNumber[last];
+        startOrder[v] = startOrder[last];
+    }
+}
+
+void SynthVoicePool::setWaveform(SynthWaveform wf)
+{
+    const int wfi = wf.getIndex();
+    for (int v = 0; v < numActive; v++) waveform[v] = wfi;
+}
+
+template <typename SampleType>
+void SynthVoicePool::addBlock(SampleType* dest, int numSamples, float level)
+{
+    masterGain.setTarget(level);
+
+    if (masterGain.isRamping() && numSamples > 0)
+    {
+        int n = jmin(numSamples, masterGain.stepsRemaining);
+        addVoices(dest, n, (SampleType)masterGain.current, (SampleType)masterGain.step);
+        masterGain.advance(n);
+        dest += n;
+        numSamples -= n;
+    }
+
+    if (numSamples > 0)
+        addVoices(dest, numSamples, (SampleType)masterGain.current, (SampleType)0);
+
+    removeFinishedVoices();
+}
+
+void SynthVoicePool::skipBlock(int numSamples, float level)
+{
+    masterGain.setTarget(level);
+    masterGain.advance(jmin(numSamples, masterGain.stepsRemaining));
+
+    for (int v = 0; v < numActive; v++)
+        phase[v] = SynthWavetable::wrapPhase(phase[v] + numSamples * phaseDelta[v]);
+
+    advanceFades(0, numActive, numSamples);
+    removeFinishedVoices();
+}
+
+template <typename SampleType>
+void SynthVoicePool::addVoices(SampleType* dest, int numSamples, SampleType level, SampleType levelStep)
+{
+    if (workerPool != nullptr && numActive >= parallelThreshold && numActive >= 2 * kMinVoicesPerTask)
+        addVoicesParallel(dest, numSamples, level, levelStep);
+    else
+        addVoiceRange(dest, numSamples, level, levelStep, 0, numActive);
+}
+
+// One task renders a contiguous range of voices into its own partial buffer
+template <typename SampleType>
+struct SynthVoicePool::RenderJob : public SynthWorkerPool::Job
+{
+    SynthVoicePool& pool;
+    SampleType* partials;
+    int numSamples, numTasks;
+    SampleType level, levelStep;
+
+    RenderJob(SynthVoicePool& p, SampleType* partialBuffers, int nTasks)
+        : pool(p), partials(partialBuffers), numSamples(0), numTasks(nTasks), level(0), levelStep(0) {}
+
+    void runTask(int t) override
+    {
+        SampleType* partial = partials + t * kPartialSamples;
+        FloatVectorOperations::clear(partial, numSamples);
+        pool.addVoiceRange(partial, numSamples, level, levelStep,
+                           pool.numActive * t / numTasks, pool.numActive * (t + 1) / numTasks);
+    }
+};
+
+template <typename SampleType>
+void SynthVoicePool::addVoicesParallel(SampleType* dest, int numSamples, SampleType level, SampleType levelStep)
+{
+    RenderJob<SampleType> job(*this, getPartials(dest), jmin(maxTasks, numActive / kMinVoicesPerTask));
+
+    for (int done = 0; done < numSamples; done += job.numSamples)
+    {
+        job.numSamples = jmin(numSamples - done, (int)kPartialSamples);
+        job.level = level + done * levelStep;
+        job.levelStep = levelStep;
+        workerPool->run(job, job.numTasks);
+
+        // sum in task order, so the result is the same whichever thread ran each task
+        for (int t = 0; t < job.numTasks; t++)
+            FloatVectorOperations::add(dest + done, job.partials + t * kPartialSamples, job.numSamples);
+    }
+}
+
+template <typename SampleType>
+void SynthVoicePool::addVoiceRange(SampleType* dest, int numSamples, SampleType level, SampleType levelStep,
+                                   int firstVoice, int endVoice)
+{
+    const SynthWavetable& wavetable = SynthWavetable::getInstance();
+
+    for (int v = firstVoice; v < endVoice; v++)
+    {
+        SynthWaveform wf;
+        wf.setIndex(waveform[v]);
+        const float* table = wavetable.getTable(wf, phaseDelta[v]);
+
+        // While the voice fades, its gain times the master level is interpolated linearly
+        // between the exact values at the ends of the fade segment
+        int start = 0;
+        float voiceGain = gain[v];
+        if (rampRemaining[v] > 0)
+        {
+            start = jmin(numSamples, rampRemaining[v]);
+            voiceGain = (start == rampRemaining[v]) ? targetGain[v] : gain[v] + start * gainStep[v];
+            const SampleType startGain = level * gain[v];
+            const SampleType endGain = (level + start * levelStep) * voiceGain;
+            SynthWavetable::addBlockRamped(table, dest, start, phase[v], phaseDelta[v],
+                                           startGain, (endGain - startGain) / start);
+        }
+
+        if (start < numSamples && voiceGain != 0.0f)
+        {
+            const double startPhase = SynthWavetable::wrapPhase(phase[v] + start * phaseDelta[v]);
+            const SampleType startLevel = level + start * levelStep;
+            if (levelStep == 0)
+                SynthWavetable::addBlock(table, dest + start, numSamples - start, startPhase, phaseDelta[v],
+                                         startLevel * voiceGain);
+            else
+                SynthWavetable::addBlockRamped(table, dest + start, numSamples - start, startPhase, phaseDelta[v],
+                                               startLevel * voiceGain, levelStep * voiceGain);
+        }
+    }
+
+    // Advance the voices' phases and fades in one pass over the contiguous arrays
+    for (int v = firstVoice; v < endVoice; v++)
+        phase[v] = SynthWavetable::wrapPhase(phase[v] + numSamples * phaseDelta[v]);
+    advanceFades(firstVoice, endVoice, numSamples);
+}
+
+template void SynthVoicePool::addBlock<float>(float*, int, float);
+template void SynthVoicePool::addBlock<double>(double*, int, float);
@@ -0,0 +1,136 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include "SynthWaveform.h"
+#include "SynthWavetable.h"
+#include "SynthRamp.h"
+#include "SynthWorkerPool.h"
+
+// Pool of wavetable voices driven by MIDI note-on/off.
+// Voice state is kept in structure-of-arrays form, and active voices are always packed into
+// lanes [0, numActive), so per-voice updates are plain loops over contiguous arrays which
+// the compiler can vectorize across voices. All storage is allocated in prepare(); nothing
+// on the audio thread allocates.
+// Voices fade in when started and fade out when released, over the smoothing time, so notes
+// neither start nor stop with a click. A voice stolen when the pool is full is released like
+// any other, fading out in one of maxVoices spare lanes while the new voice fades in.
+// With a worker pool, blocks with many active voices are rendered in parallel: the voices are
+// split into contiguous ranges, each range is rendered into its own partial buffer, and the
+// partial buffers are summed in a fixed order, so the result does not depend on which thread
+// rendered which range.
+class SynthVoicePool
+{
+public:
+    SynthVoicePool();
+
+    // Set the maximum polyphony (not counting voices fading out); takes effect at the next
+    // call to prepare()
+    void setMaxVoices(int n) { maxVoicesRequested = jmax(1, n); }
+    int getMaxVoices() const { return maxVoices; }
+
+    // Allocate voice storage (call from prepareToPlay, never from the audio thread)
+    void prepare(double sampleRate);
+
+    // Render in parallel on workers whenever at least minVoices voices are active, or never if
+    // workers is null or has no threads. Allocates partial buffers, so call after prepare(),
+    // from prepareToPlay.
+    void setWorkerPool(SynthWorkerPool* workers, int minVoices);
+
+    // Change the rate voices are rendered at, keeping the pitch of playing voices
+    // (safe on the audio thread)
+    void setSampleRate(double newSampleRate);
+
+    // Start a voice, releasing the oldest one if the pool is full
+    void noteOn(int noteNumber, float velocity, SynthWaveform wf);
+
+    // Release all voices playing the given note
+    void noteOff(int noteNumber);
+
+    void allNotesOff();
+
+    // Voices playing, including those fading out
+    int getNumActiveVoices() const { return numActive; }
+
+    // Change the waveform of all playing voices
+    void setWaveform(SynthWaveform wf);
+
+    // Set the length of master-gain ramps and of voice fades, in samples (0 to disable)
+    void setSmoothingSamples(int numSamples) { masterGain.setRampLength(numSamples); voiceRampSamples = jmax(0, numSamples); }
+
+    // Add numSamples samples of all active voices, scaled by level, into dest.
+    // A change of level ramps over the smoothing time. SampleType is float or double.
+    template <typename SampleType>
+    void addBlock(SampleType* dest, int numSamples, float level);
+
+    // True if the master gain is zero and not ramping, so addBlock() at zero level adds nothing
+    bool isSilent() const { return masterGain.current == 0.0 && !masterGain.isRamping(); }
+
+    // Advance all voices by numSamples without rendering; O(1) per voice
+    void skipBlock(int numSamples, float level);
+
+private:
+    int maxVoicesRequested, maxVoices, numActive;
+    int numLanes;               // maxVoices, plus as many again for voices fading out
+    int voiceRampSamples;
+    double sampleRate;
+    int64 noteCounter;          // incremented at every note-on, to find the oldest voice
+    SynthRamp masterGain;
+
+    // Per-voice state, structure-of-arrays
+    HeapBlock<double> phase;        // [0.0, 1.0)
+    HeapBlock<double> phaseDelta;   // cycles per sample
+    HeapBlock<float> gain;          // current gain (velocity, once faded in)
+    HeapBlock<float> gainStep;      // change of gain per sample while fading
+    HeapBlock<float> targetGain;    // gain at the end of the fade
+    HeapBlock<int> rampRemaining;   // samples of fade left
+    HeapBlock<int> releasing;       // non-zero once released: the voice ends when its fade does
+    HeapBlock<int> waveform;        // SynthWaveform index
+    HeapBlock<int> noteNumber;
+    HeapBlock<int64> startOrder;    // value of noteCounter at note-on
+
+    // Parallel rendering
+    SynthWorkerPool* workerPool;
+    int parallelThreshold;
+    int maxTasks;
+    HeapBlock<float> partialsFloat;     // maxTasks buffers of kPartialSamples
+    HeapBlock<double> partialsDouble;
+    static const int kPartialSamples = 2048;
+    static const int kMinVoicesPerTask = 8;
+
+    template <typename SampleType> struct RenderJob;
+    float* getPartials(const float*) { return partialsFloat; }
+    double* getPartials(const double*) { return partialsDouble; }
+
+    void removeVoice(int v);
+    void startFade(int v, float target);
+    void releaseVoice(int v);
+    void advanceFades(int firstVoice, int endVoice, int numSamples);
+    void removeFinishedVoices();
+    template <typename SampleType>
+    void addVoices(SampleType* dest, int numSamples, SampleType level, SampleType levelStep);
+    template <typename SampleType>
+    void addVoicesParallel(SampleType* dest, int numSamples, SampleType level, SampleType levelStep);
+    template <typename SampleType>
+    void addVoiceRange(SampleType* dest, int numSamples, SampleType level, SampleType levelStep,
+                       int firstVoice, int endVoice);
+
+    JUCE_DECLARE_NON_COPYABLE(SynthVoicePool)
+};
@@ -19,7 +19,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #pragma once
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
 
 class SynthWaveform
 {
@@ -32,6 +32,7 @@ private:
     static int textToIndex(const String& s);
 
     friend class SynthOscillator;
+    friend class SynthWavetable;
     
 public:
     // default constructor
@@ -0,0 +1,144 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SynthWavetable.h"
+#include <cmath>
+
+// Fourier coefficients (sine and cosine amplitudes) of harmonic h of each waveform,
+// chosen to match the shapes of the original naive formulas.
+void SynthWavetable::getHarmonic(int waveformIndex, int h, double& sinAmp, double& cosAmp)
+{
+    sinAmp = cosAmp = 0.0;
+    switch (waveformIndex)
+    {
+    case SynthWaveform::kSine:
+        if (h == 1) sinAmp = 1.0;
+        break;
+    case SynthWaveform::kTriangle:  // -1 at phase 0, +1 at phase 0.5
+        if (h & 1) cosAmp = -8.0 / (double_Pi * double_Pi * h * h);
+        break;
+    case SynthWaveform::kSquare:    // +1 for phase < 0.5, -1 thereafter
+        if (h & 1) sinAmp = 4.0 / (double_Pi * h);
+        break;
+    case SynthWaveform::kSawtooth:  // rising from -1 to +1
+        sinAmp = -2.0 / (double_Pi * h);
+        break;
+    }
+}
+
+const SynthWavetable& SynthWavetable::getInstance()
+{
+    static const SynthWavetable instance;
+    return instance;
+}
+
+SynthWavetable::SynthWavetable()
+{
+    // One cycle of sine, used to evaluate every harmonic exactly: sin(2*pi*h*n/N) = sine[(h*n) % N]
+    HeapBlock<double> sine, sum;
+    sine.malloc(kTableSize);
+    sum.malloc(kTableSize);
+    for (int n = 0; n < kTableSize; n++)
+        sine[n] = std::sin(2.0 * double_Pi * n / kTableSize);
+
+    const int mask = kTableSize - 1;
+    const int quarter = kTableSize / 4;
+
+    for (int wfi = 0; wfi < SynthWaveform::kChoices; wfi++)
+    {
+        // Build from the highest octave (fewest harmonics) down, adding harmonics as we go
+        for (int n = 0; n < kTableSize; n++) sum[n] = 0.0;
+        int harmonicsSoFar = 0;
+
+        for (int octave = kNumOctaves - 1; octave >= 0; octave--)
+        {
+            const int numHarmonics = kMaxHarmonics >> octave;
+            for (int h = harmonicsSoFar + 1; h <= numHarmonics; h++)
+            {
+                double sinAmp, cosAmp;
+                getHarmonic(wfi, h, sinAmp, cosAmp);
+                if (sinAmp != 0.0)
+                    for (int n = 0; n < kTableSize; n++) sum[n] += sinAmp * sine[(h * n) & mask];
+                if (cosAmp != 0.0)
+                    for (int n = 0; n < kTableSize; n++) sum[n] += cosAmp * sine[(h * n + quarter) & mask];
+            }
+            harmonicsSoFar = numHarmonics;
+
+            float* table = tables[wfi][octave];
+            for (int n = 0; n < kTableSize; n++) table[n] = (float)sum[n];
+            table[kTableSize] = table[0];
+        }
+    }
+}
+
+const float* SynthWavetable::getTable(SynthWaveform wf, double cyclesPerSample) const
+{
+    // Choose the table with the most harmonics that all lie below Nyquist (0.5 cycles/sample)
+    int octave = 0;
+    while (octave < kNumOctaves - 1 && (kMaxHarmonics >> octave) * cyclesPerSample > 0.5)
+        octave++;
+
+    return tables[wf.getIndex()][octave];
+}
+
+template <typename SampleType>
+void SynthWavetable::addBlock(const float* table, SampleType* dest, int numSamples,
+                              double startPhase, double phaseDelta, SampleType gain)
+{
+    for (int i = 0; i < numSamples; i++)
+        dest[i] += gain * lookup<SampleType>(table, wrapPhase(startPhase + i * phaseDelta));
+}
+
+template <typename SampleType>
+void SynthWavetable::addBlockRamped(const float* table, SampleType* dest, int numSamples,
+                                    double startPhase, double phaseDelta,
+                                    SampleType gain, SampleType gainStep)
+{
+    for (int i = 0; i < numSamples; i++)
+        dest[i] += (gain + i * gainStep) * lookup<SampleType>(table, wrapPhase(startPhase + i * phaseDelta));
+}
+
+template <typename SampleType>
+void SynthWavetable::renderBlockFixed(const float* table, SampleType* dest, int numSamples,
+                                      uint64 startPhase, uint64 phaseDelta, SampleType gain)
+{
+    for (int i = 0; i < numSamples; i++)
+        dest[i] = gain * lookupFixed<SampleType>(table, startPhase + (uint64)i * phaseDelta);
+}
+
+template <typename SampleType>
+void SynthWavetable::renderBlockFixedRamped(const float* table, SampleType* dest, int numSamples,
+                                            uint64 startPhase, uint64 phaseDelta, int64 deltaStep,
+                                            SampleType gainStart, SampleType gainStep, int gainOffset)
+{
+    for (int i = 0; i < numSamples; i++)
+        dest[i] = (gainStart + (gainOffset + i) * gainStep)
+                * lookupFixed<SampleType>(table, rampedPhaseFixed(startPhase, phaseDelta, deltaStep, i));
+}
+
+// The kernels are only used at these two precisions
+template void SynthWavetable::addBlock<float>(const float*, float*, int, double, double, float);
+template void SynthWavetable::addBlock<double>(const float*, double*, int, double, double, double);
+template void SynthWavetable::addBlockRamped<float>(const float*, float*, int, double, double, float, float);
+template void SynthWavetable::addBlockRamped<double>(const float*, double*, int, double, double, double, double);
+template void SynthWavetable::renderBlockFixed<float>(const float*, float*, int, uint64, uint64, float);
+template void SynthWavetable::renderBlockFixed<double>(const float*, double*, int, uint64, uint64, double);
+template void SynthWavetable::renderBlockFixedRamped<float>(const float*, float*, int, uint64, uint64, int64, float, float, int);
+template void SynthWavetable::renderBlockFixedRamped<double>(const float*, double*, int, uint64, uint64, int64, double, double, int);
@@ -0,0 +1,117 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include "SynthWaveform.h"
+
+// Precomputed, band-limited wavetables for every SynthWaveform type.
+// Each waveform has one table per octave; the table used for a given frequency contains
+// only harmonics below the Nyquist limit, so table playback does not alias.
+// The tables are built once, on first use, and are read-only thereafter, so they can be
+// shared by all oscillators (and all plugin instances) without locking.
+class SynthWavetable
+{
+public:
+    static const int kTableBits = 11;
+    static const int kTableSize = 1 << kTableBits;      // samples per cycle
+    static const int kMaxHarmonics = kTableSize / 2;    // harmonics in the lowest octave's tables
+    static const int kNumOctaves = 11;                  // kMaxHarmonics, kMaxHarmonics/2, ... 1
+
+    // Get the shared instance, building the tables if this is the first call.
+    // Call this from a non-realtime thread (e.g. prepareToPlay) before rendering.
+    static const SynthWavetable& getInstance();
+
+    // Get the table for the given waveform, band-limited for the given frequency (in cycles
+    // per sample). The returned table has kTableSize + 1 entries; the last repeats the first,
+    // so interpolating lookups need no wrap-around test.
+    const float* getTable(SynthWaveform wf, double cyclesPerSample) const;
+
+    // Linearly-interpolated lookup, for phase in [0.0, 1.0), interpolated at SampleType precision
+    template <typename SampleType>
+    static inline SampleType lookup(const float* table, double phase)
+    {
+        double x = phase * kTableSize;
+        int i = (int)x;
+        SampleType frac = (SampleType)(x - i);
+        return table[i] + frac * ((SampleType)table[i + 1] - table[i]);
+    }
+
+    // Wrap phase to [0.0, 1.0)
+    static inline double wrapPhase(double phase) { return phase - (double)(int)phase; }
+
+    // Mix numSamples samples of table playback, scaled by gain, into dest (for voices). Each
+    // sample's phase is computed directly from startPhase and the sample index, leaving no
+    // loop-carried dependency, so the compiler can vectorize these loops.
+    // SampleType is float or double, so double-precision output needs no conversion pass.
+    template <typename SampleType>
+    static void addBlock(const float* table, SampleType* dest, int numSamples,
+                         double startPhase, double phaseDelta, SampleType gain);
+
+    // As above, but with the gain ramping linearly by gainStep per sample
+    template <typename SampleType>
+    static void addBlockRamped(const float* table, SampleType* dest, int numSamples,
+                               double startPhase, double phaseDelta,
+                               SampleType gain, SampleType gainStep);
+
+    // Fixed-point phase: a fraction of a cycle in units of 2^-64 cycle. Unsigned overflow is
+    // the wrap-around, and sums and products are exact, so a fixed-point phase never drifts
+    // and its value after any number of samples can be computed directly.
+    static inline uint64 toFixed(double cycles) { return (uint64)(cycles * 18446744073709551616.0); }
+    static inline double fromFixed(uint64 fixed) { return fixed * (1.0 / 18446744073709551616.0); }
+
+    // Table lookup at a fixed-point phase: the top kTableBits bits are the table index, and
+    // the next 32 bits the interpolation fraction
+    template <typename SampleType>
+    static inline SampleType lookupFixed(const float* table, uint64 phase)
+    {
+        const int i = (int)(phase >> (64 - kTableBits));
+        const SampleType frac = (SampleType)(uint32)(phase >> (32 - kTableBits)) * (SampleType)(1.0 / 4294967296.0);
+        return table[i] + frac * ((SampleType)table[i + 1] - table[i]);
+    }
+
+    // Fixed-point phase reached after numSamples samples of a phaseDelta ramp (exact)
+    static inline uint64 rampedPhaseFixed(uint64 startPhase, uint64 phaseDelta, int64 deltaStep, int numSamples)
+    {
+        const int64 n = numSamples;
+        return startPhase + (uint64)n * phaseDelta + (uint64)deltaStep * (uint64)(n * (n - 1) / 2);
+    }
+
+    // Render numSamples samples of table playback at a fixed-point phase, scaled by gain, into
+    // dest; the ramped version also glides phaseDelta by deltaStep per sample. Every sample's phase and
+    // gain are exact functions of its position, so output does not depend on how a render
+    // is divided into blocks: the ramped gain of sample i is gainStart + (gainOffset + i) * gainStep,
+    // where gainOffset is the number of samples since the gain ramp started.
+    template <typename SampleType>
+    static void renderBlockFixed(const float* table, SampleType* dest, int numSamples,
+                                 uint64 startPhase, uint64 phaseDelta, SampleType gain);
+    template <typename SampleType>
+    static void renderBlockFixedRamped(const float* table, SampleType* dest, int numSamples,
+                                       uint64 startPhase, uint64 phaseDelta, int64 deltaStep,
+                                       SampleType gainStart, SampleType gainStep, int gainOffset);
+
+private:
+    SynthWavetable();
+
+    static void getHarmonic(int waveformIndex, int h, double& sinAmp, double& cosAmp);
+
+    float tables[SynthWaveform::kChoices][kNumOctaves][kTableSize + 1];
+
+    JUCE_DECLARE_NON_COPYABLE(SynthWavetable)
+};
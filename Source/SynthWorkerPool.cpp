@@ -0,0 +1,134 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "SynthWorkerPool.h"
+#include "RealtimeSafetyAudit.h"
+
+SynthWorkerPool::SynthWorkerPool()
+    : claimState(0)
+    , currentJob(nullptr)
+    , tasksDone(0)
+    , spinMicroseconds(kDefaultSpinMicroseconds)
+{
+}
+
+SynthWorkerPool::~SynthWorkerPool()
+{
+    stop();
+}
+
+void SynthWorkerPool::start(int numWorkers)
+{
+    if (numWorkers == workers.size()) return;
+
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+    workers.clear();
+
+    for (int i = 0; i < numWorkers; i++)
+    {
+        Worker* worker = workers.add(new Worker(*this, i));
+        worker->startThread(9);
+    }
+}
+
+void SynthWorkerPool::run(Job& job, int numTasks)
+{
+    jassert(numTasks > 0 && numTasks <= kMaxTasks);
+
+    // publish the job, then open the new generation for claims; workers which are awake see
+    // it at once, and nobody needs to be woken
+    const uint32 generation = (uint32)(claimState.load() >> 32) + 1;
+    currentJob.store(&job);
+    tasksDone.store(0);
+    claimState.store(((uint64)generation << 32) | ((uint64)numTasks << 16));
+
+    runTasks(generation);
+
+    // wait only for tasks other threads have already claimed
+    while (tasksDone.load(std::memory_order_acquire) < numTasks) {}
+}
+
+void SynthWorkerPool::runTasks(uint32 generation)
+{
+    // job may already belong to a newer generation, but then none of this generation's
+    // tasks are left, so nothing will be claimed
+    Job* job = currentJob.load();
+
+    uint64 state = claimState.load();
+    for (;;)
+    {
+        const int nextTask = (int)(state & 0xffff);
+        const int numTasks = (int)((state >> 16) & 0xffff);
+        if ((uint32)(state >> 32) != generation || nextTask >= numTasks) return;
+
+        if (claimState.compare_exchange_weak(state, state + 1))
+        {
+            {
+                // tasks are part of the audio callback, whichever thread runs them
+                RealtimeSafetyAudit::ScopedSection realtimeSection;
+                job->runTask(nextTask);
+            }
+            tasksDone.fetch_add(1, std::memory_order_release);
+            state = claimState.load();
+        }
+    }
+}
+
+SynthWorkerPool::Worker::Worker(SynthWorkerPool& p, int index)
+    : Thread("Synth worker " + String(index + 1))
+    , pool(p)
+{
+    // pin to one of cores 1..n-1, never core 0
+    const int numCpus = jmin(SystemStats::getNumCpus(), 32);
+    if (numCpus > 1)
+        setAffinityMask(1u << (1 + index % (numCpus - 1)));
+}
+
+void SynthWorkerPool::Worker::run()
+{
+    uint32 lastGeneration = (uint32)(pool.claimState.load() >> 32);
+    while (waitForJob(lastGeneration))
+        pool.runTasks(lastGeneration);
+}
+
+// Spin for the spin time, then park (polling) until a new generation is published; returns
+// false on exit
+bool SynthWorkerPool::Worker::waitForJob(uint32& lastGeneration)
+{
+    const int64 spinEnd = Time::getHighResolutionTicks()
+        + Time::getHighResolutionTicksPerSecond() * pool.spinMicroseconds.load() / 1000000;
+
+    while (!threadShouldExit())
+    {
+        const uint32 generation = (uint32)(pool.claimState.load() >> 32);
+        if (generation != lastGeneration)
+        {
+            lastGeneration = generation;
+            return true;
+        }
+
+        if (Time::getHighResolutionTicks() >= spinEnd)
+            wait(kParkedPollMilliseconds);
+    }
+    return false;
+}
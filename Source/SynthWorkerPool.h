@@ -0,0 +1,90 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+// A few worker threads which help the audio thread run one parallel job at a time.
+// The calling thread publishes a job of numTasks tasks and works on it too; every thread
+// claims task indices from a shared atomic counter until none are left, so a worker which
+// is late simply gets less (or no) work, and the caller never waits for a worker, only for
+// tasks already in progress.
+// Publishing a job is a single atomic store: the caller never signals, locks or makes a system
+// call. Idle workers spin for the spin time (set it longer than the block period, so while
+// audio is running they are always awake for the next block), then park, polling every
+// millisecond; while a worker is parked, its share of the work is done by the others, or
+// serially by the caller. Workers are pinned to cores other than core 0.
+// Threads are started and stopped on the message thread (prepareToPlay/releaseResources).
+class SynthWorkerPool
+{
+public:
+    struct Job
+    {
+        virtual ~Job() {}
+        virtual void runTask(int taskIndex) = 0;
+    };
+
+    SynthWorkerPool();
+    ~SynthWorkerPool();
+
+    // (Re)start with the given number of worker threads; 0 stops them all
+    void start(int numWorkers);
+
+    // How long an idle worker spins before parking (any thread)
+    void setSpinTime(int microseconds) { spinMicroseconds = jmax(0, microseconds); }
+    void stop() { start(0); }
+    int getNumWorkers() const { return workers.size(); }
+
+    // Run tasks [0, numTasks) of job on the workers and the calling thread; returns when all
+    // are done. Does not allocate. Not reentrant: call from one thread (the audio thread).
+    void run(Job& job, int numTasks);
+
+    static const int kMaxTasks = 0xffff;
+
+    static const int kDefaultSpinMicroseconds = 200;
+    static const int kParkedPollMilliseconds = 1;
+
+private:
+    class Worker : public Thread
+    {
+    public:
+        Worker(SynthWorkerPool& p, int index);
+        void run() override;
+
+    private:
+        SynthWorkerPool& pool;
+        bool waitForJob(uint32& lastGeneration);
+    };
+
+    // Claims and runs tasks of the given generation until there are none left
+    void runTasks(uint32 generation);
+
+    OwnedArray<Worker> workers;
+
+    // Job state. claimState packs (generation << 32 | number of tasks << 16 | next task index),
+    // so a task can only be claimed for the job it belongs to, however late a worker arrives.
+    std::atomic<uint64> claimState;
+    std::atomic<Job*> currentJob;
+    std::atomic<int> tasksDone;
+    std::atomic<int> spinMicroseconds;
+
+    JUCE_DECLARE_NON_COPYABLE(SynthWorkerPool)
+};
@@ -0,0 +1,96 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "UndoTransactionTracker.h"
+
+namespace
+{
+    // Change of one parameter's normalised value
+    class ParameterChangeAction : public UndoableAction
+    {
+    public:
+        ParameterChangeAction(AudioProcessorParameter& p, float before, float after)
+            : param(p), oldValue(before), newValue(after) {}
+
+        bool perform() override { setValue(newValue); return true; }
+        bool undo() override { setValue(oldValue); return true; }
+        int getSizeInUnits() override { return (int)sizeof(*this); }
+
+        UndoableAction* createCoalescedAction(UndoableAction* nextAction) override
+        {
+            // successive changes to the same parameter within a transaction become one
+            auto* next = dynamic_cast<ParameterChangeAction*>(nextAction);
+            if (next == nullptr || &next->param != &param) return nullptr;
+            return new ParameterChangeAction(param, oldValue, next->newValue);
+        }
+
+    private:
+        AudioProcessorParameter& param;
+        const float oldValue, newValue;
+
+        // the first perform() happens when the value has already been set
+        void setValue(float value) { if (param.getValue() != value) param.setValueNotifyingHost(value); }
+    };
+}
+
+UndoTransactionTracker::UndoTransactionTracker(AudioProcessor& p, UndoManager& um)
+    : processor(p)
+    , undoManager(um)
+    , numActiveGestures(0)
+{
+    processor.addListener(this);
+}
+
+UndoTransactionTracker::~UndoTransactionTracker()
+{
+    processor.removeListener(this);
+}
+
+void UndoTransactionTracker::audioProcessorParameterChangeGestureBegin(AudioProcessor*, int parameterIndex)
+{
+    AudioProcessorParameter* param = processor.getParameters()[parameterIndex];
+    if (param == nullptr) return;
+
+    // the first of any overlapping gestures starts the transaction
+    if (numActiveGestures++ == 0)
+        undoManager.beginNewTransaction();
+
+    if (gestureDepths.size() <= parameterIndex)
+    {
+        gestureDepths.resize(parameterIndex + 1);
+        gestureStartValues.resize(parameterIndex + 1);
+    }
+    if (gestureDepths.getReference(parameterIndex)++ == 0)
+        gestureStartValues.set(parameterIndex, param->getValue());
+}
+
+void UndoTransactionTracker::audioProcessorParameterChangeGestureEnd(AudioProcessor*, int parameterIndex)
+{
+    // ignore unmatched ends, e.g. a gesture which began before we were listening
+    if (!isPositiveAndBelow(parameterIndex, gestureDepths.size()) || gestureDepths[parameterIndex] == 0) return;
+
+    numActiveGestures--;
+    if (--gestureDepths.getReference(parameterIndex) > 0) return;
+
+    AudioProcessorParameter* param = processor.getParameters()[parameterIndex];
+    const float startValue = gestureStartValues[parameterIndex];
+    if (param->getValue() != startValue)
+        undoManager.perform(new ParameterChangeAction(*param, startValue, param->getValue()));
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2017-2018 Shane D. Dunne
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#pragma once
+#include <JuceHeader.h>
+
+// Records user edits of an AudioProcessor's parameters as undoable actions, one UndoManager
+// transaction per change gesture (e.g. one slider drag, or overlapping gestures on several
+// controls), each holding one action per parameter with its values before and after the gesture.
+// This is the only source of undo entries: the AudioProcessorValueTreeState is built without an
+// UndoManager, so host automation, which is never wrapped in a gesture by the plugin, only
+// updates the parameters' atomic values and the ValueTree, and never reaches the undo history.
+// Undo and redo set the parameters through setValueNotifyingHost(), so the host follows along.
+class UndoTransactionTracker : public AudioProcessorListener
+{
+public:
+    UndoTransactionTracker(AudioProcessor& processor, UndoManager& undoManager);
+    ~UndoTransactionTracker();
+
+    bool isGestureInProgress() const { return numActiveGestures > 0; }
+
+    // AudioProcessorListener
+    void audioProcessorParameterChanged(AudioProcessor*, int, float) override {}
+    void audioProcessorChanged(AudioProcessor*) override {}
+    void audioProcessorParameterChangeGestureBegin(AudioProcessor*, int parameterIndex) override;
+    void audioProcessorParameterChangeGestureEnd(AudioProcessor*, int parameterIndex) override;
+
+private:
+    AudioProcessor& processor;
+    UndoManager& undoManager;
+    int numActiveGestures;
+
+    // Per parameter index: nesting depth of its gestures, and its value when the outermost began
+    Array<int> gestureDepths;
+    Array<float> gestureStartValues;
+
+    JUCE_DECLARE_NON_COPYABLE(UndoTransactionTracker)
+};